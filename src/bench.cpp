@@ -0,0 +1,684 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <chrono>
+#include <list>
+#include <unordered_map>
+#include <utility>
+#include "indexed_lru.h"
+#include "list.h"
+#include "sharded_list.h"
+#include "../libs/log_generator.h"
+
+const size_t   BENCH_FRAGMENTED_SIZE = 1 << 20;
+const size_t   BENCH_QUERIES         = 64;
+const size_t   BENCH_TRAVERSAL_SIZE  = 1 << 20;
+const size_t   BENCH_TRAVERSAL_WALKS = 8;
+const size_t   BENCH_APPENDS         = 1 << 22;
+const size_t   BENCH_LRU_CAPACITY    = 1 << 16;
+const size_t   BENCH_LRU_ACCESSES    = 1 << 23;
+const size_t   BENCH_LRU_SHARDS      = 8;
+const unsigned BENCH_SEED            = 2021;
+
+typedef void (*BenchFunction)();
+
+//-----------------------------------------------------------------------------
+//! @return current time in nanoseconds.
+//-----------------------------------------------------------------------------
+double benchNow()
+{
+    return (double) std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//-----------------------------------------------------------------------------
+//! @return random number from 0 to 2^62, rand() is too short for big lists.
+//-----------------------------------------------------------------------------
+size_t benchRandom()
+{
+    return ((size_t) rand() << 31) ^ (size_t) rand();
+}
+
+//-----------------------------------------------------------------------------
+//! Fills list with values from 0 to size - 1 in order, then links them in
+//! a random order, so that every step of a walk goes to a random place of
+//! the buffer.
+//!
+//! @param [out] list   constructed empty list
+//! @param [in]  size
+//-----------------------------------------------------------------------------
+void benchFragmentedList(List* list, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        pushBack(list, (list_elem_t) i);
+    }
+
+    size_t* order = (size_t*) calloc(size, sizeof(size_t));
+    assert(order != NULL);
+
+    for (size_t i = 0; i < size; i++)
+    {
+        order[i] = i + 1;
+    }
+
+    for (size_t i = size - 1; i > 0; i--)
+    {
+        size_t other = benchRandom() % (i + 1);
+        size_t index = order[i];
+
+        order[i]     = order[other];
+        order[other] = index;
+    }
+
+    for (size_t i = 1; i < size; i++)
+    {
+        moveAfter(list, order[i], order[i - 1]);
+    }
+
+    free(order);
+}
+
+//-----------------------------------------------------------------------------
+//! Times find, LIST_SLOW::findIndex, LIST_SLOW::findPos and 
+//! LIST_SLOW::switchToIndexSearch on a list linked in random order, walking
+//! from one end and from both ends at once.
+//-----------------------------------------------------------------------------
+void benchFragmentedWalks()
+{
+    List list = {};
+    constructList(&list, BENCH_FRAGMENTED_SIZE);
+    benchFragmentedList(&list, BENCH_FRAGMENTED_SIZE);
+
+    size_t positions[BENCH_QUERIES] = {};
+    for (size_t i = 0; i < BENCH_QUERIES; i++)
+    {
+        positions[i] = benchRandom() % BENCH_FRAGMENTED_SIZE + 1;
+    }
+
+    printf("fragmented list of %zu elements, ms per call:\n", BENCH_FRAGMENTED_SIZE);
+
+    for (int twoEnded = 0; twoEnded <= 1; twoEnded++)
+    {
+        setTwoEndedSearch(&list, twoEnded);
+
+        int    index   = 0;
+        int    pos     = 0;
+        size_t checked = 0;
+
+        double start = benchNow();
+        for (size_t i = 0; i < BENCH_QUERIES; i++)
+        {
+            checked += find(&list, -1, &index, &pos);
+        }
+        double missTime = (benchNow() - start) / BENCH_QUERIES;
+
+        int indices[BENCH_QUERIES] = {};
+
+        start = benchNow();
+        for (size_t i = 0; i < BENCH_QUERIES; i++)
+        {
+            indices[i] = LIST_SLOW::findIndex(&list, positions[i]);
+        }
+        double findIndexTime = (benchNow() - start) / BENCH_QUERIES;
+
+        start = benchNow();
+        for (size_t i = 0; i < BENCH_QUERIES; i++)
+        {
+            checked += LIST_SLOW::findPos(&list, indices[i]) != (int) positions[i];
+        }
+        double findPosTime = (benchNow() - start) / BENCH_QUERIES;
+
+        start = benchNow();
+        for (size_t i = 0; i < BENCH_QUERIES; i++)
+        {
+            checked += !find(&list, at(&list, indices[i]), &index, &pos);
+        }
+        double findTime = (benchNow() - start) / BENCH_QUERIES;
+
+        List copy;
+        cloneList(&list, &copy);
+
+        start = benchNow();
+        LIST_SLOW::switchToIndexSearch(&copy);
+        double linearizeTime = benchNow() - start;
+
+        destructList(&copy);
+
+        printf("  %-10s find (miss) %6.1f  find %6.1f  findIndex %6.1f  findPos %6.1f  switchToIndexSearch %6.1f%s\n",
+               twoEnded ? "two-ended" : "one-ended", missTime / 1e6, findTime / 1e6, findIndexTime / 1e6, 
+               findPosTime / 1e6, linearizeTime / 1e6, checked != 0 ? "  (wrong results)" : "");
+    }
+
+    destructList(&list);
+}
+
+//-----------------------------------------------------------------------------
+//! Fills list with size elements, removes a random half of them and inserts
+//! as many after random elements, so that the slots new elements get are 
+//! chosen by list's allocation policy among holes all over the buffer.
+//!
+//! @param [out] list   constructed empty list with capacity over size
+//! @param [in]  size   even
+//-----------------------------------------------------------------------------
+void benchChurnedList(List* list, size_t size)
+{
+    int* live = (int*) calloc(size, sizeof(int));
+    assert(live != NULL);
+
+    for (size_t i = 0; i < size; i++)
+    {
+        live[i] = pushBack(list, (list_elem_t) i);
+    }
+
+    size_t liveCount = size;
+    for (size_t i = 0; i < size / 2; i++)
+    {
+        size_t victim = benchRandom() % liveCount;
+
+        remove(list, live[victim]);
+        live[victim] = live[--liveCount];
+    }
+
+    for (size_t i = 0; i < size / 2; i++)
+    {
+        int after = live[benchRandom() % liveCount];
+
+        live[liveCount++] = insertAfter(list, (list_elem_t) i, after);
+    }
+
+    free(live);
+}
+
+//-----------------------------------------------------------------------------
+//! Walks list from the head to the tail BENCH_TRAVERSAL_WALKS times with 
+//! finds of a missing value and prints ns per node and whether or not the 
+//! nodes buffer starts on a cache line.
+//!
+//! @param [in] list   
+//! @param [in] name   of the row
+//-----------------------------------------------------------------------------
+void benchTraverse(List* list, const char* name)
+{
+    int    index   = 0;
+    int    pos     = 0;
+    size_t checked = 0;
+
+    double start = benchNow();
+    for (size_t walk = 0; walk < BENCH_TRAVERSAL_WALKS; walk++)
+    {
+        checked += find(list, -1, &index, &pos);
+    }
+    double time = (benchNow() - start) / BENCH_TRAVERSAL_WALKS / list->size;
+
+    bool aligned = (uintptr_t) list->nodes % LIST_NODES_ALIGNMENT == 0;
+
+    printf("  %-18s %7.2f  %s%s\n", name, time, aligned ? "yes" : "no", checked != 0 ? "  (wrong results)" : "");
+}
+
+//-----------------------------------------------------------------------------
+//! Times traversals of lists that had half of their elements replaced at
+//! random places, with every allocation policy, and of a linearized one.
+//!
+//! @note Hardware cache miss counters aren't read. A step to a node that 
+//!       isn't cached costs a miss, so ns per node stands for them.
+//-----------------------------------------------------------------------------
+void benchTraversal()
+{
+    printf("churned list of %zu elements, traversal:\n", BENCH_TRAVERSAL_SIZE);
+    printf("  %-18s ns/node  aligned\n", "allocation");
+
+    const ListAllocationPolicy policies[] = {LIST_ALLOCATION_LIFO, LIST_ALLOCATION_BLOCKED, LIST_ALLOCATION_NEAREST};
+    const char*                names[]    = {"lifo",               "blocked",               "nearest"              };
+
+    for (size_t i = 0; i < sizeof(policies) / sizeof(policies[0]); i++)
+    {
+        srand(BENCH_SEED);
+
+        List list = {};
+        constructList(&list, BENCH_TRAVERSAL_SIZE + 1);
+        setAllocationPolicy(&list, policies[i]);
+
+        benchChurnedList(&list, BENCH_TRAVERSAL_SIZE);
+        benchTraverse(&list, names[i]);
+
+        if (policies[i] == LIST_ALLOCATION_LIFO)
+        {
+            LIST_SLOW::switchToIndexSearch(&list);
+            benchTraverse(&list, "lifo, linearized");
+        }
+
+        destructList(&list);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//! Work of one appending thread: count appends either to its shard of 
+//! sharded or to shared under lock.
+//-----------------------------------------------------------------------------
+struct BenchAppender
+{
+    ShardedList*     sharded;
+    List*            shared;
+    pthread_mutex_t* lock;
+    size_t           shard;
+    size_t           count;
+};
+
+//-----------------------------------------------------------------------------
+//! @param [in] argument   BenchAppender
+//-----------------------------------------------------------------------------
+void* benchShardedAppender(void* argument)
+{
+    BenchAppender* appender = (BenchAppender*) argument;
+
+    for (size_t i = 0; i < appender->count; i++)
+    {
+        shardedPushBack(appender->sharded, appender->shard, (list_elem_t) i);
+    }
+
+    return NULL;
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] argument   BenchAppender
+//-----------------------------------------------------------------------------
+void* benchSharedAppender(void* argument)
+{
+    BenchAppender* appender = (BenchAppender*) argument;
+
+    for (size_t i = 0; i < appender->count; i++)
+    {
+        pthread_mutex_lock(appender->lock);
+        pushBack(appender->shared, (list_elem_t) i);
+        pthread_mutex_unlock(appender->lock);
+    }
+
+    return NULL;
+}
+
+//-----------------------------------------------------------------------------
+//! Runs every appender in a thread of its own.
+//!
+//! @param [in] function   benchShardedAppender or benchSharedAppender
+//! @param [in] appenders   
+//! @param [in] threads   
+//!
+//! @return time from the first start to the last join in nanoseconds.
+//-----------------------------------------------------------------------------
+double benchRunAppenders(void* (*function)(void*), BenchAppender* appenders, size_t threads)
+{
+    pthread_t ids[SHARDED_LIST_MAX_SHARDS] = {};
+
+    double start = benchNow();
+
+    for (size_t i = 0; i < threads; i++)
+    {
+        pthread_create(&ids[i], NULL, function, &appenders[i]);
+    }
+
+    for (size_t i = 0; i < threads; i++)
+    {
+        pthread_join(ids[i], NULL);
+    }
+
+    return benchNow() - start;
+}
+
+//-----------------------------------------------------------------------------
+//! mergeNext as it was before the heap: compares the current elements of all
+//! the shards for every element taken.
+//!
+//! @param [out] iterator   started by beginMerge
+//!
+//! @return whether or not there was an element left.
+//-----------------------------------------------------------------------------
+bool benchScanMergeNext(ShardedListIterator* iterator)
+{
+    ShardedList* list     = iterator->list;
+    size_t       minShard = 0;
+    uint64_t     minStamp = UINT64_MAX;
+
+    for (size_t i = 0; i < list->shardsCount; i++)
+    {
+        int index = iterator->indices[i];
+
+        if (index != 0 && list->shards[i].stamps[index] < minStamp)
+        {
+            minShard = i;
+            minStamp = list->shards[i].stamps[index];
+        }
+    }
+
+    if (minStamp == UINT64_MAX) { return false; }
+
+    iterator->indices[minShard] = chainNext(&list->shards[minShard].list, iterator->indices[minShard], 0);
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//! Times BENCH_APPENDS appends split between 1 to SHARDED_LIST_MAX_SHARDS 
+//! threads, to their own shards of a ShardedList and to one List under a 
+//! mutex, then the merge of the shards with mergeNext and with a scan of 
+//! all the shards per element.
+//!
+//! @note Threads only run in parallel up to the number of online cores,
+//!       which is printed first.
+//-----------------------------------------------------------------------------
+void benchShardedAppends()
+{
+    printf("%zu appends, %ld online cores:\n", BENCH_APPENDS, sysconf(_SC_NPROCESSORS_ONLN));
+    printf("  threads  sharded Mappends/s  shared+mutex Mappends/s  merge heap ns  merge scan ns\n");
+
+    for (size_t threads = 1; threads <= SHARDED_LIST_MAX_SHARDS; threads *= 2)
+    {
+        size_t perThread = BENCH_APPENDS / threads;
+
+        ShardedList sharded = {};
+        List        shared  = {};
+        constructShardedList(&sharded, threads, perThread + 1);
+        constructList(&shared, BENCH_APPENDS + 1);
+
+        pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+
+        BenchAppender appenders[SHARDED_LIST_MAX_SHARDS] = {};
+        for (size_t i = 0; i < threads; i++)
+        {
+            appenders[i] = {&sharded, &shared, &lock, i, perThread};
+        }
+
+        double shardedTime = benchRunAppenders(benchShardedAppender, appenders, threads);
+        double sharedTime  = benchRunAppenders(benchSharedAppender,  appenders, threads);
+
+        ShardedListIterator iterator = {};
+        size_t              merged   = 0;
+
+        // the first walk over the shards would pay for cold caches
+        for (beginMerge(&sharded, &iterator); benchScanMergeNext(&iterator); ) {}
+
+        double start = benchNow();
+        for (beginMerge(&sharded, &iterator); mergeNext(&iterator, NULL, NULL); ) { merged++; }
+        double heapTime = benchNow() - start;
+
+        start = benchNow();
+        for (beginMerge(&sharded, &iterator); benchScanMergeNext(&iterator); ) { merged--; }
+        double scanTime = benchNow() - start;
+
+        size_t total = perThread * threads;
+
+        printf("  %7zu  %18.1f  %23.1f  %13.1f  %13.1f%s\n", threads, 
+               total / shardedTime * 1e3, total / sharedTime * 1e3, heapTime / total, scanTime / total,
+               merged != 0 || shared.size != total ? "  (wrong results)" : "");
+
+        destructList(&shared);
+        destructShardedList(&sharded);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//! The usual LRU cache the IndexedLRU is compared with: a std::list of 
+//! entries in recency order and a std::unordered_map from keys to them.
+//-----------------------------------------------------------------------------
+struct BenchStdLRU
+{
+    typedef std::list<std::pair<uint64_t, uint64_t>> Entries;
+
+    Entries                                         entries;
+    std::unordered_map<uint64_t, Entries::iterator> map;
+    size_t                                          capacity;
+    size_t                                          hits;
+};
+
+//-----------------------------------------------------------------------------
+//! Looks key up in cache, caching it on a miss like benchLRUAccesses does.
+//!
+//! @param [out] cache
+//! @param [in]  key
+//-----------------------------------------------------------------------------
+void benchStdLRUAccess(BenchStdLRU* cache, uint64_t key)
+{
+    auto found = cache->map.find(key);
+
+    if (found != cache->map.end())
+    {
+        cache->entries.splice(cache->entries.begin(), cache->entries, found->second);
+        cache->hits++;
+        return;
+    }
+
+    if (cache->entries.size() == cache->capacity)
+    {
+        cache->map.erase(cache->entries.back().first);
+        cache->entries.pop_back();
+    }
+
+    cache->entries.emplace_front(key, key);
+    cache->map[key] = cache->entries.begin();
+}
+
+//-----------------------------------------------------------------------------
+//! Looks every key up in cache and puts it on a miss.
+//!
+//! @param [out] cache   IndexedLRU or ShardedIndexedLRU
+//! @param [in]  keys   
+//! @param [in]  count   
+//!
+//! @return time taken in nanoseconds.
+//-----------------------------------------------------------------------------
+template <typename Cache>
+double benchLRUAccesses(Cache* cache, const uint64_t* keys, size_t count)
+{
+    double start = benchNow();
+
+    for (size_t i = 0; i < count; i++)
+    {
+        uint64_t value = 0;
+        if (!cache->get(keys[i], &value)) { cache->put(keys[i], keys[i]); }
+    }
+
+    return benchNow() - start;
+}
+
+//-----------------------------------------------------------------------------
+//! Times IndexedLRU, ShardedIndexedLRU (from one thread, so it only adds 
+//! locking) and BenchStdLRU on the same sequence of BENCH_LRU_ACCESSES keys,
+//! for key ranges giving different hit rates.
+//-----------------------------------------------------------------------------
+void benchLRU()
+{
+    uint64_t* keys = (uint64_t*) calloc(BENCH_LRU_ACCESSES, sizeof(uint64_t));
+    assert(keys != NULL);
+
+    printf("LRU cache of %zu entries, %zu accesses, ns per access:\n", BENCH_LRU_CAPACITY, BENCH_LRU_ACCESSES);
+    printf("  key range  hit rate  IndexedLRU  ShardedIndexedLRU  std::list+unordered_map\n");
+
+    const size_t ranges[] = {BENCH_LRU_CAPACITY / 2, BENCH_LRU_CAPACITY * 5 / 4, BENCH_LRU_CAPACITY * 2, BENCH_LRU_CAPACITY * 8};
+
+    for (size_t range : ranges)
+    {
+        for (size_t i = 0; i < BENCH_LRU_ACCESSES; i++)
+        {
+            keys[i] = benchRandom() % range;
+        }
+
+        IndexedLRU<uint64_t, uint64_t>                          indexed(BENCH_LRU_CAPACITY);
+        ShardedIndexedLRU<uint64_t, uint64_t, BENCH_LRU_SHARDS> sharded(BENCH_LRU_CAPACITY);
+        BenchStdLRU                                             standard = {};
+        standard.capacity = BENCH_LRU_CAPACITY;
+
+        double indexedTime = benchLRUAccesses(&indexed, keys, BENCH_LRU_ACCESSES);
+        double shardedTime = benchLRUAccesses(&sharded, keys, BENCH_LRU_ACCESSES);
+
+        double start = benchNow();
+        for (size_t i = 0; i < BENCH_LRU_ACCESSES; i++)
+        {
+            benchStdLRUAccess(&standard, keys[i]);
+        }
+        double standardTime = benchNow() - start;
+
+        // the sharded cache evicts per shard, so only the other two must agree
+        printf("  %9zu  %7.1f%%  %10.1f  %17.1f  %23.1f%s\n", range, 100.0 * indexed.hits() / BENCH_LRU_ACCESSES,
+               indexedTime / BENCH_LRU_ACCESSES, shardedTime / BENCH_LRU_ACCESSES, standardTime / BENCH_LRU_ACCESSES,
+               indexed.hits() != standard.hits ? "  (wrong results)" : "");
+    }
+
+    free(keys);
+}
+
+//-----------------------------------------------------------------------------
+//! Runs walks through LIST_SLOW::walkMany, restoring their queries first.
+//!
+//! @param [out] walks   
+//! @param [in]  count   
+//! @param [in]  inFlight   
+//!
+//! @return number of walks that found the element they were expected to.
+//-----------------------------------------------------------------------------
+size_t benchWalkMany(ListWalk* walks, size_t count, size_t inFlight)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        walks[i].idx = 0;
+        if (walks[i].kind == LIST_WALK_FIND) { walks[i].pos = 0; }
+    }
+
+    LIST_SLOW::walkMany(walks, count, inFlight);
+
+    size_t found = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        found += walks[i].kind == LIST_WALK_FIND ? walks[i].idx == (int) walks[i].value + 1
+                                                 : walks[i].idx != 0;
+    }
+
+    return found;
+}
+
+//-----------------------------------------------------------------------------
+//! Times finds and LIST_SLOW::findIndex'es on a list linked in random order,
+//! one after another and interleaved by LIST_SLOW::walkMany, then 
+//! findIndex'es with the rank index, which walkMany answers without walking.
+//-----------------------------------------------------------------------------
+void benchWalkMany()
+{
+    List list = {};
+    constructList(&list, BENCH_FRAGMENTED_SIZE);
+    benchFragmentedList(&list, BENCH_FRAGMENTED_SIZE);
+
+    // element at index i has value i - 1
+    ListWalk finds  [BENCH_QUERIES] = {};
+    ListWalk indices[BENCH_QUERIES] = {};
+
+    for (size_t i = 0; i < BENCH_QUERIES; i++)
+    {
+        finds[i].list  = &list;
+        finds[i].kind  = LIST_WALK_FIND;
+        finds[i].value = (list_elem_t) (benchRandom() % BENCH_FRAGMENTED_SIZE);
+
+        indices[i].list = &list;
+        indices[i].kind = LIST_WALK_FIND_INDEX;
+        indices[i].pos  = benchRandom() % BENCH_FRAGMENTED_SIZE + 1;
+    }
+
+    printf("fragmented list of %zu elements, %zu queries, ms per query:\n", BENCH_FRAGMENTED_SIZE, BENCH_QUERIES);
+
+    size_t found = 0;
+    int    index = 0;
+    int    pos   = 0;
+
+    double start = benchNow();
+    for (size_t i = 0; i < BENCH_QUERIES; i++)
+    {
+        find(&list, finds[i].value, &index, &pos);
+        found += index == (int) finds[i].value + 1;
+    }
+    double findTime = benchNow() - start;
+
+    start = benchNow();
+    for (size_t i = 0; i < BENCH_QUERIES; i++)
+    {
+        found += LIST_SLOW::findIndex(&list, indices[i].pos) != 0;
+    }
+    double findIndexTime = benchNow() - start;
+
+    printf("  %-22s find %6.2f  findIndex %6.2f%s\n", "one by one", findTime / BENCH_QUERIES / 1e6, 
+           findIndexTime / BENCH_QUERIES / 1e6, found != 2 * BENCH_QUERIES ? "  (wrong results)" : "");
+
+    const size_t inFlights[] = {1, 4, 8, 16, 32};
+
+    for (size_t inFlight : inFlights)
+    {
+        start = benchNow();
+        found = benchWalkMany(finds, BENCH_QUERIES, inFlight);
+        findTime = benchNow() - start;
+
+        start = benchNow();
+        found += benchWalkMany(indices, BENCH_QUERIES, inFlight);
+        findIndexTime = benchNow() - start;
+
+        printf("  walkMany, %2zu in flight  find %6.2f  findIndex %6.2f%s\n", inFlight, findTime / BENCH_QUERIES / 1e6, 
+               findIndexTime / BENCH_QUERIES / 1e6, found != 2 * BENCH_QUERIES ? "  (wrong results)" : "");
+    }
+
+    enableRankIndex(&list);
+
+    start = benchNow();
+    for (size_t i = 0; i < BENCH_QUERIES; i++)
+    {
+        found += LIST_SLOW::findIndex(&list, indices[i].pos) != 0;
+    }
+    double rankTime = benchNow() - start;
+
+    start = benchNow();
+    found = benchWalkMany(indices, BENCH_QUERIES, 16);
+    double rankWalksTime = benchNow() - start;
+
+    printf("  rank index             findIndex %.4f one by one, %.4f by walkMany%s\n", rankTime / BENCH_QUERIES / 1e6, 
+           rankWalksTime / BENCH_QUERIES / 1e6, found != BENCH_QUERIES ? "  (wrong results)" : "");
+
+    destructList(&list);
+}
+
+struct Bench
+{
+    const char*   name;
+    BenchFunction function;
+};
+
+const Bench BENCHES[] =
+{
+    {"fragmented_walks", benchFragmentedWalks},
+    {"traversal",        benchTraversal      },
+    {"sharded_appends",  benchShardedAppends },
+    {"lru",              benchLRU            },
+    {"walk_many",        benchWalkMany       },
+};
+
+//-----------------------------------------------------------------------------
+//! Runs the benchmarks named in arguments or all of them if there are none.
+//! Has to be built without LIST_DEBUG_MODE, whose checks would dominate.
+//-----------------------------------------------------------------------------
+int main(int argc, const char* argv[])
+{
+    srand(BENCH_SEED);
+
+    for (const Bench& bench : BENCHES)
+    {
+        bool selected = argc == 1;
+        for (int i = 1; i < argc; i++)
+        {
+            if (strcmp(argv[i], bench.name) == 0) { selected = true; }
+        }
+
+        if (selected) { bench.function(); }
+    }
+
+    LG_Close();
+
+    return 0;
+}
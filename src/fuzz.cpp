@@ -0,0 +1,22 @@
+#include <stddef.h>
+#include <stdint.h>
+#include "indexed_lru_ops.h"
+#include "list_ops.h"
+#include "sharded_list_ops.h"
+#include "static_list_ops.h"
+#include "unrolled_list_ops.h"
+
+//-----------------------------------------------------------------------------
+//! libFuzzer entry point. The input is interpreted as a sequence of list 
+//! operations on every container, see list_ops.h and its counterparts.
+//-----------------------------------------------------------------------------
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    runListOps        (data, size);
+    runUnrolledListOps(data, size);
+    runStaticListOps  (data, size);
+    runShardedListOps (data, size);
+    runLRUOps         (data, size);
+
+    return 0;
+}
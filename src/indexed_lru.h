@@ -0,0 +1,427 @@
+#ifndef INDEXED_LRU_H
+#define INDEXED_LRU_H
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <functional>
+#include <mutex>
+#include <new>
+#include "list.h"
+
+//-----------------------------------------------------------------------------
+//! Fixed capacity LRU cache. Recency order is kept by a List (front is the
+//! most recently used entry), keys and values live in arrays parallel to the
+//! list's buffer and an open-addressing table maps keys to node indices.
+//! Nothing is allocated after construction: the list never grows and a hit
+//! only relinks its node.
+//!
+//! @warning K and V must be default constructible and copy assignable.
+//-----------------------------------------------------------------------------
+template <typename K, typename V, typename Hash = std::hash<K>>
+class IndexedLRU
+{
+public:
+    explicit IndexedLRU(size_t capacity);
+    ~IndexedLRU();
+
+    IndexedLRU(const IndexedLRU&)            = delete;
+    IndexedLRU& operator=(const IndexedLRU&) = delete;
+
+    bool   isConstructed() const { return table_ != NULL; }
+
+    bool   get  (const K& key, V* value);
+    bool   put  (const K& key, const V& value);
+    bool   erase(const K& key);
+
+    size_t size()     const { return list_.size; }
+    size_t capacity() const { return capacity_; }
+    size_t hits()     const { return hits_; }
+    size_t misses()   const { return misses_; }
+
+private:
+    size_t homeOf    (const K& key) const;
+    size_t slotOf    (const K& key) const;
+    void   tableErase(size_t slot);
+
+    List   list_      = {};
+    K*     keys_      = NULL;
+    V*     values_    = NULL;
+    int*   table_     = NULL;
+    size_t tableMask_ = 0;
+    size_t capacity_  = 0;
+    size_t hits_      = 0;
+    size_t misses_    = 0;
+    Hash   hash_      = Hash();
+};
+
+//-----------------------------------------------------------------------------
+//! LRU cache split into Shards independent IndexedLRU's, each guarded by its
+//! own mutex, so that threads working with different keys rarely contend.
+//! A key always goes to the same shard.
+//-----------------------------------------------------------------------------
+template <typename K, typename V, size_t Shards, typename Hash = std::hash<K>>
+class ShardedIndexedLRU
+{
+public:
+    explicit ShardedIndexedLRU(size_t capacity);
+    ~ShardedIndexedLRU();
+
+    ShardedIndexedLRU(const ShardedIndexedLRU&)            = delete;
+    ShardedIndexedLRU& operator=(const ShardedIndexedLRU&) = delete;
+
+    bool   isConstructed() const;
+
+    bool   get  (const K& key, V* value);
+    bool   put  (const K& key, const V& value);
+    bool   erase(const K& key);
+
+    size_t size();
+    size_t hits();
+    size_t misses();
+
+    size_t shardIndex(const K& key) const;
+
+private:
+    struct Shard
+    {
+        std::mutex              mutex;
+        IndexedLRU<K, V, Hash>* cache = NULL;
+    };
+
+    Shard& shardOf(const K& key);
+
+    Shard shards_[Shards];
+    Hash  hash_ = Hash();
+};
+
+//-----------------------------------------------------------------------------
+//! @param [in] capacity   maximal number of entries
+//!
+//! @note If an allocation failed, isConstructed returns false and every
+//!       other call fails.
+//-----------------------------------------------------------------------------
+template <typename K, typename V, typename Hash>
+IndexedLRU<K, V, Hash>::IndexedLRU(size_t capacity)
+{
+    assert(capacity > 0);
+
+    if (constructList(&list_, capacity) == NULL) { return; }
+
+    size_t tableSize = 1;
+    while (tableSize < 2 * capacity) { tableSize *= 2; }
+
+    keys_   = new (std::nothrow) K[list_.capacity];
+    values_ = new (std::nothrow) V[list_.capacity];
+    table_  = (int*) calloc(tableSize, sizeof(int));
+
+    if (keys_ == NULL || values_ == NULL || table_ == NULL)
+    {
+        free(table_);
+        table_ = NULL;
+        return;
+    }
+
+    tableMask_ = tableSize - 1;
+    capacity_  = capacity;
+}
+
+template <typename K, typename V, typename Hash>
+IndexedLRU<K, V, Hash>::~IndexedLRU()
+{
+    if (list_.nodes != NULL) { destructList(&list_); }
+
+    delete[] keys_;
+    delete[] values_;
+    free(table_);
+}
+
+//-----------------------------------------------------------------------------
+//! Looks key up and makes it the most recently used entry on a hit.
+//!
+//! @param [in]  key
+//! @param [out] value   set to key's value on a hit (can be NULL)
+//!
+//! @return whether or not key is cached.
+//-----------------------------------------------------------------------------
+template <typename K, typename V, typename Hash>
+bool IndexedLRU<K, V, Hash>::get(const K& key, V* value)
+{
+    if (table_ == NULL) { return false; }
+
+    size_t index = table_[slotOf(key)];
+
+    if (index == 0)
+    {
+        misses_++;
+        return false;
+    }
+
+    hits_++;
+    moveAfter(&list_, index, 0);
+
+    if (value != NULL) { *value = values_[index]; }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//! Caches value for key as the most recently used entry. If the cache is
+//! full, the least recently used entry is evicted.
+//!
+//! @param [in] key
+//! @param [in] value
+//!
+//! @return whether or not value has been cached.
+//-----------------------------------------------------------------------------
+template <typename K, typename V, typename Hash>
+bool IndexedLRU<K, V, Hash>::put(const K& key, const V& value)
+{
+    if (table_ == NULL) { return false; }
+
+    size_t slot  = slotOf(key);
+    size_t index = table_[slot];
+
+    if (index != 0)
+    {
+        values_[index] = value;
+        moveAfter(&list_, index, 0);
+
+        return true;
+    }
+
+    if (list_.size == capacity_)
+    {
+        size_t evicted = list_.tail;
+
+        tableErase(slotOf(keys_[evicted]));
+        remove(&list_, evicted);
+
+        // backward shift could have moved key's probe position
+        slot = slotOf(key);
+    }
+
+    index = pushFront(&list_, 0);
+    assert(index != 0);
+
+    keys_[index]   = key;
+    values_[index] = value;
+    table_[slot]   = index;
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] key
+//!
+//! @return whether or not key was cached.
+//-----------------------------------------------------------------------------
+template <typename K, typename V, typename Hash>
+bool IndexedLRU<K, V, Hash>::erase(const K& key)
+{
+    if (table_ == NULL) { return false; }
+
+    size_t slot  = slotOf(key);
+    size_t index = table_[slot];
+
+    if (index == 0) { return false; }
+
+    tableErase(slot);
+    remove(&list_, index);
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] key
+//!
+//! @return slot of the table where key's probe sequence starts.
+//-----------------------------------------------------------------------------
+template <typename K, typename V, typename Hash>
+size_t IndexedLRU<K, V, Hash>::homeOf(const K& key) const
+{
+    uint64_t hash = (uint64_t) hash_(key);
+
+    // std::hash is often the identity, so the bits get mixed first
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDull;
+    hash ^= hash >> 33;
+
+    return (size_t) hash & tableMask_;
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] key
+//!
+//! @return table slot holding key's node index or the empty slot where it
+//!         would be inserted.
+//-----------------------------------------------------------------------------
+template <typename K, typename V, typename Hash>
+size_t IndexedLRU<K, V, Hash>::slotOf(const K& key) const
+{
+    size_t slot = homeOf(key);
+    while (table_[slot] != 0 && !(keys_[table_[slot]] == key))
+    {
+        slot = (slot + 1) & tableMask_;
+    }
+
+    return slot;
+}
+
+//-----------------------------------------------------------------------------
+//! Empties slot of the table, shifting the following entries of its probe
+//! sequence back so that lookups don't need tombstones.
+//!
+//! @param [in] slot
+//-----------------------------------------------------------------------------
+template <typename K, typename V, typename Hash>
+void IndexedLRU<K, V, Hash>::tableErase(size_t slot)
+{
+    size_t next = (slot + 1) & tableMask_;
+
+    while (table_[next] != 0)
+    {
+        size_t home = homeOf(keys_[table_[next]]);
+
+        // moves the entry back if its home isn't in (slot, next]
+        if (((next - home) & tableMask_) >= ((next - slot) & tableMask_))
+        {
+            table_[slot] = table_[next];
+            slot         = next;
+        }
+
+        next = (next + 1) & tableMask_;
+    }
+
+    table_[slot] = 0;
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] capacity   maximal number of entries in all shards together
+//-----------------------------------------------------------------------------
+template <typename K, typename V, size_t Shards, typename Hash>
+ShardedIndexedLRU<K, V, Shards, Hash>::ShardedIndexedLRU(size_t capacity)
+{
+    static_assert(Shards > 0, "at least one shard");
+
+    size_t shardCapacity = (capacity + Shards - 1) / Shards;
+
+    for (size_t i = 0; i < Shards; i++)
+    {
+        shards_[i].cache = new (std::nothrow) IndexedLRU<K, V, Hash>(shardCapacity);
+    }
+}
+
+template <typename K, typename V, size_t Shards, typename Hash>
+ShardedIndexedLRU<K, V, Shards, Hash>::~ShardedIndexedLRU()
+{
+    for (size_t i = 0; i < Shards; i++)
+    {
+        delete shards_[i].cache;
+    }
+}
+
+template <typename K, typename V, size_t Shards, typename Hash>
+bool ShardedIndexedLRU<K, V, Shards, Hash>::isConstructed() const
+{
+    for (size_t i = 0; i < Shards; i++)
+    {
+        if (shards_[i].cache == NULL || !shards_[i].cache->isConstructed()) { return false; }
+    }
+
+    return true;
+}
+
+template <typename K, typename V, size_t Shards, typename Hash>
+bool ShardedIndexedLRU<K, V, Shards, Hash>::get(const K& key, V* value)
+{
+    Shard& shard = shardOf(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    return shard.cache != NULL && shard.cache->get(key, value);
+}
+
+template <typename K, typename V, size_t Shards, typename Hash>
+bool ShardedIndexedLRU<K, V, Shards, Hash>::put(const K& key, const V& value)
+{
+    Shard& shard = shardOf(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    return shard.cache != NULL && shard.cache->put(key, value);
+}
+
+template <typename K, typename V, size_t Shards, typename Hash>
+bool ShardedIndexedLRU<K, V, Shards, Hash>::erase(const K& key)
+{
+    Shard& shard = shardOf(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    return shard.cache != NULL && shard.cache->erase(key);
+}
+
+template <typename K, typename V, size_t Shards, typename Hash>
+size_t ShardedIndexedLRU<K, V, Shards, Hash>::size()
+{
+    size_t size = 0;
+    for (size_t i = 0; i < Shards; i++)
+    {
+        std::lock_guard<std::mutex> lock(shards_[i].mutex);
+        if (shards_[i].cache != NULL) { size += shards_[i].cache->size(); }
+    }
+
+    return size;
+}
+
+template <typename K, typename V, size_t Shards, typename Hash>
+size_t ShardedIndexedLRU<K, V, Shards, Hash>::hits()
+{
+    size_t hits = 0;
+    for (size_t i = 0; i < Shards; i++)
+    {
+        std::lock_guard<std::mutex> lock(shards_[i].mutex);
+        if (shards_[i].cache != NULL) { hits += shards_[i].cache->hits(); }
+    }
+
+    return hits;
+}
+
+template <typename K, typename V, size_t Shards, typename Hash>
+size_t ShardedIndexedLRU<K, V, Shards, Hash>::misses()
+{
+    size_t misses = 0;
+    for (size_t i = 0; i < Shards; i++)
+    {
+        std::lock_guard<std::mutex> lock(shards_[i].mutex);
+        if (shards_[i].cache != NULL) { misses += shards_[i].cache->misses(); }
+    }
+
+    return misses;
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] key
+//!
+//! @return number of the shard key belongs to, from 0 to Shards - 1. Uses 
+//!         the high bits of the hash, the low ones pick the slot inside the
+//!         shard's table.
+//-----------------------------------------------------------------------------
+template <typename K, typename V, size_t Shards, typename Hash>
+size_t ShardedIndexedLRU<K, V, Shards, Hash>::shardIndex(const K& key) const
+{
+    uint64_t hash = (uint64_t) hash_(key) * 0x9E3779B97F4A7C15ull;
+
+    return (hash >> 32) % Shards;
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] key
+//!
+//! @return shard key belongs to.
+//-----------------------------------------------------------------------------
+template <typename K, typename V, size_t Shards, typename Hash>
+typename ShardedIndexedLRU<K, V, Shards, Hash>::Shard& ShardedIndexedLRU<K, V, Shards, Hash>::shardOf(const K& key)
+{
+    return shards_[shardIndex(key)];
+}
+
+#endif
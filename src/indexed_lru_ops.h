@@ -0,0 +1,198 @@
+#ifndef INDEXED_LRU_OPS_H
+#define INDEXED_LRU_OPS_H
+
+#include <stdint.h>
+#include <iterator>
+#include <list>
+#include <utility>
+#include "indexed_lru.h"
+#include "list_ops.h"
+
+//-----------------------------------------------------------------------------
+//! Interpreter of byte strings as sequences of IndexedLRU and
+//! ShardedIndexedLRU operations, checked against a std::list of key-value
+//! pairs in recency order (the front is the most recently used entry) per
+//! shard. Keys come from a small range, so that hits, evictions and table
+//! collisions are all frequent.
+//-----------------------------------------------------------------------------
+
+static const size_t LRU_OPS_KEYS   = 32;
+static const size_t LRU_OPS_SHARDS = 4;
+
+typedef IndexedLRU<int, int>                        LRUOpsCache;
+typedef ShardedIndexedLRU<int, int, LRU_OPS_SHARDS> LRUOpsShardedCache;
+typedef std::list<std::pair<int, int>>              LRUModel;
+
+enum LRUOp
+{
+    LRU_OP_GET,
+    LRU_OP_PUT,
+    LRU_OP_ERASE,
+
+    LRU_OPS_COUNT
+};
+
+//-----------------------------------------------------------------------------
+//! @param [in] model
+//! @param [in] key
+//!
+//! @return iterator to key's entry in model or model's end.
+//-----------------------------------------------------------------------------
+inline LRUModel::iterator lruOpsModelFind(LRUModel* model, int key)
+{
+    for (LRUModel::iterator entry = model->begin(); entry != model->end(); entry++)
+    {
+        if (entry->first == key) { return entry; }
+    }
+
+    return model->end();
+}
+
+//-----------------------------------------------------------------------------
+//! @return shard of cache key belongs to, a plain cache has only one.
+//-----------------------------------------------------------------------------
+inline size_t lruOpsShard(LRUOpsCache*,              int)     { return 0;                      }
+inline size_t lruOpsShard(LRUOpsShardedCache* cache, int key) { return cache->shardIndex(key); }
+
+//-----------------------------------------------------------------------------
+//! Applies the operation read from input to cache and the model of the
+//! shard its key belongs to.
+//!
+//! @param [out] cache
+//! @param [out] models   one per shard
+//! @param [in]  shards   number of models
+//! @param [in]  capacity   capacity of every shard
+//! @param [out] input
+//-----------------------------------------------------------------------------
+template <typename Cache>
+inline void lruOpsStep(Cache* cache, LRUModel* models, size_t shards, size_t capacity, ListOpsInput* input)
+{
+    uint8_t op    = listOpsByte(input) % LRU_OPS_COUNT;
+    int     key   = listOpsByte(input) % LRU_OPS_KEYS;
+    int     value = listOpsByte(input);
+
+    LRUModel*          model = &models[lruOpsShard(cache, key)];
+    LRUModel::iterator entry = lruOpsModelFind(model, key);
+
+    switch (op)
+    {
+        case LRU_OP_GET:
+        {
+            size_t hits   = cache->hits();
+            size_t misses = cache->misses();
+
+            int  cached = -1;
+            bool hit    = cache->get(key, &cached);
+
+            LIST_OPS_CHECK(hit == (entry != model->end()));
+            LIST_OPS_CHECK(cache->hits() == hits + hit && cache->misses() == misses + !hit);
+
+            if (hit)
+            {
+                LIST_OPS_CHECK(cached == entry->second);
+                model->splice(model->begin(), *model, entry);
+            }
+
+            break;
+        }
+
+        case LRU_OP_PUT:
+        {
+            LIST_OPS_CHECK(cache->put(key, value));
+
+            if (entry != model->end())
+            {
+                entry->second = value;
+                model->splice(model->begin(), *model, entry);
+                break;
+            }
+
+            if (model->size() == capacity) { model->pop_back(); }
+            model->emplace_front(key, value);
+            break;
+        }
+
+        case LRU_OP_ERASE:
+        {
+            LIST_OPS_CHECK(cache->erase(key) == (entry != model->end()));
+
+            if (entry != model->end()) { model->erase(entry); }
+            break;
+        }
+
+        default:
+        {
+            break;
+        }
+    }
+
+    size_t size = 0;
+    for (size_t shard = 0; shard < shards; shard++) { size += models[shard].size(); }
+
+    LIST_OPS_CHECK(cache->size() == size);
+}
+
+//-----------------------------------------------------------------------------
+//! Runs the operations encoded by input on cache, checking it against the
+//! models after every one of them and every entry at the end. Aborts on the
+//! first mismatch.
+//!
+//! @param [out] cache
+//! @param [in]  shards   number of cache's shards
+//! @param [in]  capacity   capacity of every shard
+//! @param [out] input
+//-----------------------------------------------------------------------------
+template <typename Cache>
+inline void lruOpsRun(Cache* cache, size_t shards, size_t capacity, ListOpsInput* input)
+{
+    LIST_OPS_CHECK(cache->isConstructed());
+
+    LRUModel models[LRU_OPS_SHARDS] = {};
+
+    while (input->read < input->size)
+    {
+        lruOpsStep(cache, models, shards, capacity, input);
+    }
+
+    // reading entries from the least recently used one keeps models' order
+    for (size_t shard = 0; shard < shards; shard++)
+    {
+        for (LRUModel::reverse_iterator entry = models[shard].rbegin(); entry != models[shard].rend(); entry++)
+        {
+            int cached = -1;
+
+            LIST_OPS_CHECK(cache->get(entry->first, &cached));
+            LIST_OPS_CHECK(cached == entry->second);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//! Runs the operations encoded by data on a new cache and on a new sharded
+//! cache.
+//!
+//! @param [in] data
+//! @param [in] size
+//-----------------------------------------------------------------------------
+inline void runLRUOps(const uint8_t* data, size_t size)
+{
+    ListOpsInput input = {};
+    input.data = data;
+    input.size = size;
+
+    size_t      capacity = listOpsByte(&input) % 16 + 1;
+    LRUOpsCache cache(capacity);
+
+    lruOpsRun(&cache, 1, capacity, &input);
+
+    // the sharded cache splits its capacity between the shards rounding up
+    input.read = 0;
+
+    LRUOpsShardedCache shardedCache(capacity);
+    size_t             shardCapacity = (capacity + LRU_OPS_SHARDS - 1) / LRU_OPS_SHARDS;
+
+    listOpsByte(&input);
+    lruOpsRun(&shardedCache, LRU_OPS_SHARDS, shardCapacity, &input);
+}
+
+#endif
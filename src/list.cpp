@@ -1,12 +1,70 @@
 #include <assert.h>
 #include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <new>
 #include "list.h"
 #include "../libs/log_generator.h"
 
+#ifdef LIST_SHARED_MEMORY_ENABLED
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#ifdef LIST_PROFILING_ENABLED
+#include <time.h>
+#include <unistd.h>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
+
 const unsigned char LIST_MAX_ERRORS_COUNT  = 20;
 const unsigned char LIST_MAX_DOT_CMD_SIZE  = 64;
-const double        LIST_EXPAND_MULTIPLIER = 1.8;
 const size_t        LIST_MINIMAL_CAPACITY  = 4;
+const size_t        LIST_MMAP_THRESHOLD    = 128 * 1024;
+const size_t        LIST_MALLOC_OVERHEAD   = 2 * sizeof(size_t);
+const size_t        LIST_BLOCKED_SEARCH_DEPTH = 8;
+const size_t        LIST_FREE_MAP_WORD_BITS   = 64;
+const size_t        LIST_MAX_WALKS_IN_FLIGHT  = 32;
+
+#if defined(__GNUC__) || defined(__clang__)
+#define LIST_CTZ(word)      __builtin_ctzll(word)
+#define LIST_CLZ(word)      __builtin_clzll(word)
+#define LIST_POPCOUNT(word) __builtin_popcountll(word)
+#else
+#define LIST_CTZ(word)      listCtz(word)
+#define LIST_CLZ(word)      listClz(word)
+#define LIST_POPCOUNT(word) listPopcount(word)
+
+int listCtz(uint64_t word)
+{
+    int count = 0;
+    while (!((word >> count) & 1)) { count++; }
+
+    return count;
+}
+
+int listClz(uint64_t word)
+{
+    int count = 0;
+    while (!((word << count) >> 63)) { count++; }
+
+    return count;
+}
+
+int listPopcount(uint64_t word)
+{
+    int count = 0;
+    for (; word != 0; word &= word - 1) { count++; }
+
+    return count;
+}
+#endif
 
 struct ListNode
 {
@@ -15,43 +73,271 @@ struct ListNode
     int         next  = -1;
 };
 
-bool      listFreeLoop    (List* list);
+struct ListQuery
+{
+    list_elem_t value = 0;
+    size_t      idx   = 0;
+    size_t      order = 0;
+};
+
+struct ListWalkState
+{
+    ListWalk* walk     = NULL;
+    size_t    index    = 0;
+    size_t    step     = 0;
+    size_t    steps    = 0;
+    bool      backward = false;
+};
+
+struct ListBatchEntry
+{
+    list_elem_t value      = 0;
+    int         index      = 0;
+    int         prev       = 0;
+    int         next       = 0;
+    uint32_t    generation = 0;
+    size_t      freeHint   = 0;
+    bool        inserted   = false;
+};
+
+struct ListBatch
+{
+    ListBatchEntry* log           = NULL;
+    size_t          size          = 0;
+    size_t          capacity      = 0;
+    bool            searchEnabled = true;
+};
+
+const size_t LIST_SNAPSHOT_CHUNK_NODES = LIST_PAGE_SIZE / sizeof(ListNode);
+
+struct ListChunk
+{
+    std::atomic<size_t> references;
+    ListNode            nodes[LIST_SNAPSHOT_CHUNK_NODES];
+};
+
+struct ListLink
+{
+    int prev = 0;
+    int next = 0;
+};
+
+struct ListRankNode
+{
+    int      parent   = 0;
+    int      left     = 0;
+    int      right    = 0;
+    uint32_t size     = 0;
+    uint32_t priority = 0;
+};
+
+struct ListRetired
+{
+    void*    block = NULL;
+    uint64_t epoch = 0;
+};
+
+struct ListEpochs
+{
+    std::atomic<ListNode*> nodes;
+    std::atomic<size_t>    capacity;
+    std::atomic<size_t>    head;
+    std::atomic<uint64_t>  epoch;
+
+    std::atomic<uint64_t>* readers      = NULL;
+    size_t                 readersCount = 0;
+
+    ListRetired*           retired         = NULL;
+    size_t                 retiredSize     = 0;
+    size_t                 retiredCapacity = 0;
+};
+
+#ifdef LIST_SHARED_MEMORY_ENABLED
+struct ListSharedHeader
+{
+    pthread_mutex_t   lock;
+    std::atomic<bool> ready;
+    uint64_t          generation    = 0;
+    size_t            mappingSize   = 0;
+
+    size_t            size          = 0;
+    size_t            capacity      = 0;
+    size_t            head          = 0;
+    size_t            tail          = 0;
+    size_t            free          = 0;
+    size_t            freeWatermark = 0;
+    bool              searchEnabled = true;
+    uint32_t          errorStatus   = 0;
+};
+
+struct ListShared
+{
+    int               fd          = -1;
+    ListSharedHeader* header      = NULL;
+    size_t            mappingSize = 0;
+    uint64_t          generation  = 0;
+};
+#endif
+
+#ifdef LIST_PROFILING_ENABLED
+//-----------------------------------------------------------------------------
+//! Calling thread's perf event group. slots[i] is counter i's position in
+//! the group's read buffer or -1 if the counter couldn't be opened.
+//-----------------------------------------------------------------------------
+struct ListPerfCounters
+{
+    bool   opened = false;
+    int    leader = -1;
+    int    fds  [LIST_COUNTERS_COUNT] = {};
+    int    slots[LIST_COUNTERS_COUNT] = {};
+    size_t count  = 0;
+
+    ~ListPerfCounters();
+};
+
+//-----------------------------------------------------------------------------
+//! Measures one call from its construction to its destruction and adds the
+//! result to list's profile of op.
+//-----------------------------------------------------------------------------
+struct ListProfileScope
+{
+    List*           list     = NULL;
+    ListProfiledOp  op       = LIST_PROFILE_INSERT;
+    bool            measured = false;
+    uint64_t        start[LIST_COUNTERS_COUNT] = {};
+    timespec        startTime = {};
+
+    ListProfileScope(List* list, ListProfiledOp op);
+    ~ListProfileScope();
+};
+
+#define LIST_PROFILE(list, op) ListProfileScope listProfileScope(list, op)
+#else
+#define LIST_PROFILE(list, op)
+#endif
+
+struct ListSnapshot
+{
+    ListChunk** chunks   = NULL;
+    size_t      size     = 0;
+    size_t      capacity = 0;
+    size_t      head     = 0;
+    size_t      tail     = 0;
+    size_t      version  = 0;
+};
+
 int       getLastFree     (List* list);
 void      listUpdateFree  (List* list, size_t begin);
+size_t    listHashValue   (list_elem_t value);
+size_t    listHashLookup  (List* list, list_elem_t value);
+void      listHashInsert  (List* list, size_t idx);
+void      listHashRemove  (List* list, size_t idx);
+bool      listHashRebuild (List* list);
+uint32_t  listRankPriority(List* list);
+void      listRankRotateUp(List* list, size_t idx);
+void      listRankInsert  (List* list, size_t idx, size_t after);
+void      listRankRemove  (List* list, size_t idx);
+void      listRankRebuild (List* list);
+size_t    listRankPosOf   (List* list, size_t idx);
+size_t    listRankIndexAt (List* list, size_t pos);
+bool      listRankOk      (List* list);
+int       listPosOf       (List* list, size_t idx);
+size_t    listBound       (List* list, list_elem_t value, bool upper);
+#ifdef LIST_DEBUG_MODE
+bool      listSortedOk    (List* list);
+#endif
+void      listLinearize   (List* list, bool prevValid);
+void      listLinearizeNode(List* list, ListNode* newNodes, uint32_t* newGenerations, size_t oldIndex, size_t newIndex);
+bool      listFindTwoEnded(List* list, list_elem_t value, int* idx, int* pos);
+bool      listWalkStart   (ListWalkState* state, ListWalk* walk);
+bool      listWalkStep    (ListWalkState* state);
+int       listCompareQueryIdx  (const void* first, const void* second);
+int       listCompareQueryValue(const void* first, const void* second);
+size_t    listSortSplit   (List* list, size_t first, size_t count);
+void      listSortLinks   (List* list, ListComparator less);
+bool      listDefaultLess (list_elem_t first, list_elem_t second);
+bool      listBatchGrow   (List* list);
+void      listBatchLog    (List* list, size_t idx, bool inserted, size_t freeHint);
+void      listBatchUndo   (List* list, ListBatchEntry* entry);
+size_t    listChunksCount (size_t capacity);
+void      listChunkRelease(ListChunk* chunk);
+void      listSnapshotTouch   (List* list, size_t idx);
+void      listSnapshotTouchAll(List* list);
+void      listSnapshotResize  (List* list, size_t oldCapacity);
+ListNode* listSnapshotNode    (ListSnapshot* snapshot, size_t idx);
+void      listEpochRetire     (List* list, void* oldBlock);
+void      listSetHead         (List* list, size_t head);
+#ifdef LIST_SHARED_MEMORY_ENABLED
+bool      listSharedCreate    (List* list, size_t capacity);
+bool      listSharedAttach    (List* list);
+bool      listSharedMap       (List* list, size_t size);
+void      listSharedLoad      (List* list);
+ListNode* listSharedResize    (List* list, size_t newCapacity);
+void      listSharedClose     (List* list);
+size_t    listSharedFreeMapOffset(size_t capacity);
+size_t    listSharedBytes     (size_t capacity);
+#endif
+ListLink* listChainLink       (List* list, size_t idx, size_t chain);
+void      listChainLinkAfter  (List* list, size_t idx, size_t after, size_t chain);
+void      listChainUnlink     (List* list, size_t idx, size_t chain);
+void      listLinearizeChains (List* list, ListNode* oldNodes, size_t oldHead, size_t oldCapacity);
+bool      listChainsOk        (List* list);
+void      listMove        (List* to, List* from);
+void*     listCloneArray  (const void* array, size_t bytes, bool* failed);
 ListNode* resize          (List* list, size_t newCapacity);
+size_t    listNodesBytes  (size_t capacity);
+ListNode* listAlignNodes  (void* block);
+ListNode* listAllocNodes  (size_t capacity, void** block);
+ListNode* listReallocNodes(List* list, size_t newCapacity);
+size_t    listTakeFree    (List* list, size_t idx);
+size_t    listFreeMapWords(size_t capacity);
+void      listFreeMapSet  (List* list, size_t idx, bool isFree);
+bool      listIsFree      (List* list, size_t idx);
+uint64_t  listFreeWord    (List* list, size_t word);
+size_t    listFindFreeFrom(List* list, size_t idx);
+size_t    listFindFreeNear(List* list, size_t idx);
+void      listPushFreed   (List* list, size_t idx);
+size_t    listPopFreed    (List* list);
+bool      listFreeMapOk   (List* list);
+size_t    listRoundCapacity(List* list, size_t capacity);
+size_t    listGrowCapacity(List* list);
 void      setError        (List* list, ListError error);
+#ifdef LIST_PROFILING_ENABLED
+void      listPerfOpen        (ListPerfCounters* perf);
+bool      listPerfRead        (ListPerfCounters* perf, uint64_t* counters);
+const char* listProfiledOpStr (ListProfiledOp op);
+const char* listCounterStr    (ListCounter counter);
+void      dumpProfile     (List* list);
+#endif
 void      dumpPrintErrors (List* list, const char* indentation);
 void      dumpGraph       (List* list);
 
 //-----------------------------------------------------------------------------
-//! Updates free list, sets values to LIST_POISON if LIST_POISONING_ENABLED
-//! is defined and sets prev values to -1.
+//! Marks slots from begin to the end of list's buffer as free by lowering 
+//! list's free watermark. Slots above the watermark are free regardless of 
+//! list's free slots bitmap, so this works in O(1) unless 
+//! LIST_POISONING_ENABLED is defined, then the values are set to LIST_POISON.
 //!
 //! @param [out] list  
-//! @param [in]  begin     
+//! @param [in]  begin   slots from begin must not be used by list
 //-----------------------------------------------------------------------------
 void listUpdateFree(List* list, size_t begin)
 {
     assert(list != NULL);
-    assert(begin > list->size);
+    assert(begin > 0);
 
-    if (list->free == 0) { list->free = begin; }
+    if (begin >= list->capacity) { return; }
 
+    #ifdef LIST_POISONING_ENABLED
     for (size_t i = begin; i < list->capacity; i++)
     {
-        #ifdef LIST_POISONING_ENABLED
         list->nodes[i].value = LIST_POISON;
-        #endif
+    }
+    #endif
 
-        list->nodes[i].prev = -1;
+    if (begin < list->freeWatermark) { list->freeWatermark = begin; }
 
-        if (list->free == begin && i == list->capacity - 1)
-            list->nodes[i].next = 0;
-        else if (i == list->capacity - 1)
-            list->nodes[i].next = list->free;
-        else
-            list->nodes[i].next = i + 1;
-    }
+    list->free = begin;
 }
 
 #ifdef LIST_POISONING_ENABLED
@@ -89,24 +375,27 @@ bool listCheckPoison(List* list)
         valueIterator = list->nodes[valueIterator].next;
     }
 
-    size_t maxFreeCount = list->capacity - list->size - 1;
-    int    freeIterator = list->free;
-
-    for (size_t i = 0; freeIterator != 0; i++)
+    for (size_t word = 0; word < listFreeMapWords(list->freeWatermark); word++)
     {
-        if (i > maxFreeCount - 1)
+        for (uint64_t bits = listFreeWord(list, word); bits != 0; bits &= bits - 1)
         {
-            setError(list, LIST_FREE_LIST_LOOP);
-            return false;
+            size_t i = word * LIST_FREE_MAP_WORD_BITS + LIST_CTZ(bits);
+
+            if (!IS_LIST_POISON(list->nodes[i].value))
+            {
+                setError(list, LIST_MEMORY_CORRUPTION);
+                return false;
+            }
         }
+    }
 
-        if (!IS_LIST_POISON(list->nodes[freeIterator].value))
+    for (size_t i = list->freeWatermark; i < list->capacity; i++)
+    {
+        if (!IS_LIST_POISON(list->nodes[i].value))
         {
             setError(list, LIST_MEMORY_CORRUPTION);
             return false;
         }
-
-        freeIterator = list->nodes[freeIterator].next;
     }
 
     return true;
@@ -253,21 +542,18 @@ List* fconstructList(List* list, size_t capacity)
     list->size     = 0;
     list->capacity = capacity + 1 > LIST_MINIMAL_CAPACITY ? capacity + 1 : LIST_MINIMAL_CAPACITY;
 
-    list->nodes = (ListNode*) ((char*)calloc(1, list->capacity * sizeof(ListNode) 
+    list->nodes   = listAllocNodes(list->capacity, &list->nodesBlock);
+    list->freeMap = (uint64_t*) calloc(listFreeMapWords(list->capacity), sizeof(uint64_t));
 
-                                                   #ifdef LIST_CANARIES_ENABLED
-                                                   + sizeof(LIST_ARRAY_CANARY_L) 
-                                                   + sizeof(LIST_ARRAY_CANARY_R) 
-                                                   #endif 
-                                            )
+    if (list->nodes == NULL || list->freeMap == NULL) 
+    {
+        free(list->nodesBlock);
+        free(list->freeMap);
 
-                                            #ifdef LIST_CANARIES_ENABLED
-                                            + sizeof(LIST_ARRAY_CANARY_L)
-                                            #endif 
-                              );
+        list->nodes      = NULL;
+        list->nodesBlock = NULL;
+        list->freeMap    = NULL;
 
-    if (list->nodes == NULL) 
-    {
         setError(list, LIST_CONSTRUCTION_FAILED);
         ASSERT_LIST_OK(list);
         return NULL;
@@ -291,6 +577,7 @@ List* fconstructList(List* list, size_t capacity)
     list->status = LIST_STATUS_CONSTRUCTED;
     #endif
 
+    list->freeWatermark = list->capacity;
     listUpdateFree(list, 1);
 
     ASSERT_LIST_OK(list);
@@ -334,29 +621,269 @@ List* fconstructList(List* list)
 void destructList(List* list)
 {
     ASSERT_LIST_OK(list);
+    assert(list->shared == NULL);
 
-    #ifdef LIST_CANARIES_ENABLED
-    free((char*)list->nodes - sizeof(LIST_ARRAY_CANARY_L));
-    #else
-    free(list->nodes);
-    #endif
+    free(list->nodesBlock);
 
-    list->size     = 0;
-    list->capacity = 0;
-    list->nodes    = NULL;
+    if (list->batch != NULL)
+    {
+        free(list->batch->log);
+        free(list->batch);
+        list->batch = NULL;
+    }
+
+    free(list->generations);
+    free(list->hashTable);
+    free(list->hashChain);
+    free(list->freeMap);
+    free(list->rankNodes);
+
+    if (list->snapshotChunks != NULL)
+    {
+        listSnapshotTouchAll(list);
+        free(list->snapshotChunks);
+        list->snapshotChunks = NULL;
+    }
+
+    free(list->chainLinks);
+    list->chainLinks  = NULL;
+    list->chainsCount = 1;
+
+    if (list->epochs != NULL)
+    {
+        for (size_t i = 0; i < list->epochs->retiredSize; i++)
+        {
+            free(list->epochs->retired[i].block);
+        }
+
+        free(list->epochs->retired);
+        delete[] list->epochs->readers;
+        delete list->epochs;
+        list->epochs = NULL;
+    }
+
+    list->freeMap       = NULL;
+    list->size          = 0;
+    list->capacity      = 0;
+    list->nodes         = NULL;
+    list->nodesBlock    = NULL;
+    list->generations   = NULL;
+    list->hashTable     = NULL;
+    list->hashChain     = NULL;
+    list->hashTableSize = 0;
+    list->rankNodes     = NULL;
+    list->rankRoot      = 0;
 
     #ifdef LIST_DEBUG_MODE
     list->status   = LIST_STATUS_DESTRUCTED;
     #endif
 }
 
+//-----------------------------------------------------------------------------
+//! Takes other's buffers in O(1), leaving other not constructed.
+//!
+//! @param [out] other   
+//!
+//! @warning Readers and handles' remap callbacks refer to the list by its
+//!          address, so a list with concurrent reads in progress must not be
+//!          moved.
+//-----------------------------------------------------------------------------
+List::List(List&& other) noexcept
+{
+    listMove(this, &other);
+}
+
+//-----------------------------------------------------------------------------
+//! Destructs (or closes, if it's shared) this list and takes other's 
+//! buffers in O(1), leaving other not constructed.
+//!
+//! @param [out] other   
+//!
+//! @return this list.
+//-----------------------------------------------------------------------------
+List& List::operator=(List&& other) noexcept
+{
+    if (this == &other) { return *this; }
+
+    if (shared != NULL)
+    {
+        #ifdef LIST_SHARED_MEMORY_ENABLED
+        closeSharedList(this);
+        #endif
+    }
+    else if (nodes != NULL)
+    {
+        destructList(this);
+    }
+
+    listMove(this, &other);
+
+    return *this;
+}
+
+//-----------------------------------------------------------------------------
+//! Copies list to clone with one memcpy per buffer, so that the copy has the
+//! same layout, indices and handles as list.
+//!
+//! @param [in]  list   
+//! @param [out] clone   not constructed list
+//!
+//! @note The clone gets list's hash index, rank index, generations and 
+//!       chains, but not its snapshots, concurrent reads, remap callback or
+//!       shared memory object.
+//!
+//! @warning A shared list must be locked while it's cloned.
+//!
+//! @return clone if cloned successfully or NULL otherwise.
+//-----------------------------------------------------------------------------
+List* cloneList(List* list, List* clone)
+{
+    ASSERT_LIST_OK(list);
+    assert(clone != NULL && clone != list);
+    assert(list->batch == NULL);
+
+    memcpy((void*) clone, (const void*) list, sizeof(List));
+
+    clone->snapshotChunks  = NULL;
+    clone->snapshotVersion = 0;
+    clone->epochs          = NULL;
+    clone->shared          = NULL;
+    clone->remapCallback   = NULL;
+    clone->remapContext    = NULL;
+
+    size_t capacity = list->capacity;
+    bool   failed   = false;
+
+    clone->nodes       = listAllocNodes(capacity, &clone->nodesBlock);
+    clone->freeMap     = (uint64_t*)     listCloneArray(list->freeMap,     listFreeMapWords(capacity) * sizeof(uint64_t), &failed);
+    clone->generations = (uint32_t*)     listCloneArray(list->generations, capacity * sizeof(uint32_t), &failed);
+    clone->hashTable   = (int*)          listCloneArray(list->hashTable,   list->hashTableSize * sizeof(int), &failed);
+    clone->hashChain   = (int*)          listCloneArray(list->hashChain,   capacity * sizeof(int), &failed);
+    clone->rankNodes   = (ListRankNode*) listCloneArray(list->rankNodes,   capacity * sizeof(ListRankNode), &failed);
+    clone->chainLinks  = (ListLink*)     listCloneArray(list->chainLinks,  capacity * (list->chainsCount - 1) * sizeof(ListLink), &failed);
+
+    if (clone->nodes == NULL || failed)
+    {
+        free(clone->nodesBlock);
+        free(clone->freeMap);
+        free(clone->generations);
+        free(clone->hashTable);
+        free(clone->hashChain);
+        free(clone->rankNodes);
+        free(clone->chainLinks);
+
+        new (clone) List();
+
+        setError(clone, LIST_CONSTRUCTION_FAILED);
+        return NULL;
+    }
+
+    memcpy(clone->nodes, list->nodes, capacity * sizeof(ListNode));
+    LIST_SET_CANARIES(clone);
+
+    #ifdef LIST_DEBUG_MODE
+    clone->name = LIST_DYNAMICALLY_CREATED_NAME;
+    #endif
+
+    #ifdef LIST_PROFILING_ENABLED
+    resetProfile(clone);
+    #endif
+
+    ASSERT_LIST_OK(clone);
+
+    return clone;
+}
+
+//-----------------------------------------------------------------------------
+//! Copies list's elements in order to clone in one pass, so that clone is 
+//! compact (its capacity is list's size) and already linearized, like after
+//! LIST_SLOW::switchToIndexSearch.
+//!
+//! @param [in]  list   
+//! @param [out] clone   not constructed list
+//!
+//! @note Indices change, so the clone's hash index, rank index, chains and
+//!       generations (if list has them) are built anew and handles to list's
+//!       elements aren't valid in it.
+//!
+//! @return clone if cloned successfully or NULL otherwise.
+//-----------------------------------------------------------------------------
+List* cloneLinearized(List* list, List* clone)
+{
+    ASSERT_LIST_OK(list);
+    assert(clone != NULL && clone != list);
+    assert(list->batch == NULL);
+
+    size_t capacity = list->size > 0 ? list->size : 1;
+
+    #ifdef LIST_DEBUG_MODE
+    if (fconstructList(clone, capacity, LIST_DYNAMICALLY_CREATED_NAME) == NULL) { return NULL; }
+    #else
+    if (fconstructList(clone, capacity) == NULL) { return NULL; }
+    #endif
+
+    clone->growthPolicy     = list->growthPolicy;
+    clone->growthFactor     = list->growthFactor;
+    clone->growthStep       = list->growthStep;
+    clone->twoEndedSearch   = list->twoEndedSearch;
+    clone->allocationPolicy = list->allocationPolicy;
+
+    ListNode* nodes = clone->nodes;
+    size_t    size  = list->size;
+    size_t    index = list->head;
+
+    for (size_t pos = 1; pos <= size; pos++)
+    {
+        nodes[pos].value = list->nodes[index].value;
+        nodes[pos].prev  = pos - 1;
+        nodes[pos].next  = pos < size ? pos + 1 : 0;
+
+        index = list->nodes[index].next;
+    }
+
+    clone->size          = size;
+    clone->head          = size > 0 ? 1 : 0;
+    clone->tail          = size;
+    clone->freeWatermark = size + 1;
+    clone->free          = size + 1;
+    clone->searchEnabled = false;
+
+    if (list->chainLinks != NULL)
+    {
+        bool failed = false;
+
+        clone->chainLinks = (ListLink*) listCloneArray(list->chainLinks, list->capacity * (list->chainsCount - 1) * sizeof(ListLink), &failed);
+
+        if (failed)
+        {
+            destructList(clone);
+            return NULL;
+        }
+
+        clone->chainsCount = list->chainsCount;
+        listLinearizeChains(clone, list->nodes, list->head, list->capacity);
+    }
+
+    if ((list->generations != NULL && !enableGenerations(clone)) ||
+        (list->hashTable   != NULL && !enableHashIndex  (clone)) ||
+        (list->rankNodes   != NULL && !enableRankIndex  (clone)))
+    {
+        destructList(clone);
+        return NULL;
+    }
+
+    ASSERT_LIST_OK(clone);
+
+    return clone;
+}
+
 //-----------------------------------------------------------------------------
 //! Allocates a List, calls constructor and returns the pointer to this list.
 //!
 //! @param [in] capacity   
 //!
-//! @note if calloc returned NULL then sets list's errorStatus to 
-//!       LIST_INITIALIZATION_FAILED.
+//! @note List has default member initializers, so it's constructed in the 
+//!       allocated memory with placement new rather than left zeroed.
 //! @note if capacity is less than LIST_MINIMAL_CAPACITY, than sets capacity
 //!       to LIST_MINIMAL_CAPACITY.
 //!
@@ -366,13 +893,22 @@ List* newList(size_t capacity)
 {
     assert(capacity > 0);
 
-    List* newList = (List*) calloc(1, sizeof(List));
+    void* memory = calloc(1, sizeof(List));
+    if (memory == NULL) { return NULL; }
+
+    List* newList = new (memory) List();
 
     #ifdef LIST_DEBUG_MODE
-    fconstructList(newList, LIST_DYNAMICALLY_CREATED_NAME);
+    if (fconstructList(newList, capacity, LIST_DYNAMICALLY_CREATED_NAME) == NULL)
     #else
-    fconstructList(newList);
+    if (fconstructList(newList, capacity) == NULL)
     #endif
+    {
+        newList->~List();
+        free(memory);
+
+        return NULL;
+    }
 
     return newList;
 }
@@ -380,8 +916,6 @@ List* newList(size_t capacity)
 //-----------------------------------------------------------------------------
 //! Allocates a List, calls constructor and returns the pointer to this list.
 //!
-//! @note if calloc returned NULL then sets list's errorStatus to 
-//!       LIST_INITIALIZATION_FAILED.
 //! @note starting capacity is LIST_DEFAULT_CAPACITY
 //!
 //! @return list if constructed successfully or NULL otherwise.
@@ -396,6 +930,9 @@ List* newList()
 //! wasn't created dynamically using newList() or an allocator.
 //!
 //! @param [out] list   
+//!
+//! @note list was constructed with placement new, so its lifetime is ended 
+//!       with an explicit ~List() call before the memory is freed.
 //-----------------------------------------------------------------------------
 void deleteList(List* list)
 {
@@ -403,6 +940,7 @@ void deleteList(List* list)
 
     destructList(list);
 
+    list->~List();
     free(list);
 }
 
@@ -431,437 +969,1136 @@ size_t getCapacity(List* list)
 }
 
 //-----------------------------------------------------------------------------
-//! @param [in] list   
+//! Makes sure list can hold size elements without reallocation.
 //!
-//! @return whether or not list is empty.
+//! @param [out] list   
+//! @param [in]  size   
+//!
+//! @note Capacity is rounded up according to list's growth policy.
+//! @note Does nothing if list's capacity is already big enough.
+//! @note Elements keep their indices, so a linearized list stays linearized.
+//!
+//! @return whether or not there is enough space for size elements.
 //-----------------------------------------------------------------------------
-bool isEmpty(List* list)
+bool reserve(List* list, size_t size)
 {
     ASSERT_LIST_OK(list);
 
-    return list->size == 0;
+    if (size + 1 <= list->capacity) { return true; }
+
+    return resize(list, listRoundCapacity(list, size + 1)) != NULL;
 }
 
 //-----------------------------------------------------------------------------
-//! @param [in] list   
+//! Sets the way free slots are chosen for inserted elements.
 //!
-//! @return current errorStatus of list.
+//! @param [out] list   
+//! @param [in]  policy   LIST_ALLOCATION_LIFO takes the most recently freed
+//!              slot (one of the last LIST_FREED_STACK_SIZE ones), 
+//!              LIST_ALLOCATION_BLOCKED prefers a free slot in the cache line 
+//!              of the new element's neighbours, LIST_ALLOCATION_NEAREST 
+//!              takes the free slot closest to the new element's neighbour
 //-----------------------------------------------------------------------------
-uint32_t getErrorStatus(List* list)
+void setAllocationPolicy(List* list, ListAllocationPolicy policy)
 {
-    assert(list != NULL);
+    ASSERT_LIST_OK(list);
 
-    return list->errorStatus;
+    list->allocationPolicy = policy;
 }
 
 //-----------------------------------------------------------------------------
-//! Adds error to list's errorStatus.
+//! @param [in] capacity   
+//!
+//! @return number of words in the free slots bitmap of a list with capacity.
+//-----------------------------------------------------------------------------
+size_t listFreeMapWords(size_t capacity)
+{
+    return (capacity + LIST_FREE_MAP_WORD_BITS - 1) / LIST_FREE_MAP_WORD_BITS;
+}
+
+//-----------------------------------------------------------------------------
+//! Marks slot idx in list's free slots bitmap.
 //!
 //! @param [out] list   
-//! @param [in]  error   
+//! @param [in]  idx   
+//! @param [in]  isFree   
 //-----------------------------------------------------------------------------
-void setError(List* list, ListError error)
+void listFreeMapSet(List* list, size_t idx, bool isFree)
 {
-    assert(list != NULL);
+    assert(list          != NULL);
+    assert(list->freeMap != NULL);
+    assert(idx > 0 && idx < list->capacity);
 
-    list->errorStatus |= error;
+    uint64_t bit = (uint64_t) 1 << (idx % LIST_FREE_MAP_WORD_BITS);
+
+    if (isFree) { list->freeMap[idx / LIST_FREE_MAP_WORD_BITS] |=  bit; }
+    else        { list->freeMap[idx / LIST_FREE_MAP_WORD_BITS] &= ~bit; }
 }
 
-//----------------------------------------------------------------------------- 
-//! @param [in] error   
-//!    
-//! @return string representation of error (e.g. error = LIST_POP_FROM_EMPTY
-//!         returns "LIST_POP_FROM_EMPTY").   
 //-----------------------------------------------------------------------------
-const char* getErrorStr(ListError error)
+//! @param [in] list   
+//! @param [in] idx   
+//!
+//! @return whether or not slot idx isn't used by list.
+//-----------------------------------------------------------------------------
+bool listIsFree(List* list, size_t idx)
 {
-    #define TO_STR(value) #value
+    assert(list          != NULL);
+    assert(list->freeMap != NULL);
+    assert(idx < list->capacity);
 
-    switch (error)
-    {
-        case LIST_NO_ERROR:            return TO_STR(LIST_NO_ERROR);
-        case LIST_POP_FROM_EMPTY:      return TO_STR(LIST_POP_FROM_EMPTY);
-        case LIST_TOP_FROM_EMPTY:      return TO_STR(LIST_TOP_FROM_EMPTY);
-        case LIST_CONSTRUCTION_FAILED: return TO_STR(LIST_CONSTRUCTION_FAILED);
-        case LIST_REALLOCATION_FAILED: return TO_STR(LIST_REALLOCATION_FAILED);
-        case LIST_MEMORY_CORRUPTION:   return TO_STR(LIST_MEMORY_CORRUPTION);
-        case LIST_FREE_LIST_LOOP:      return TO_STR(LIST_FREE_LIST_LOOP);
-        case LIST_LOOP:                return TO_STR(LIST_LOOP);
-        case LIST_ACCESSING_ZERO:      return TO_STR(LIST_ACCESSING_ZERO);
-
-        #ifdef LIST_DEBUG_MODE
-        case LIST_NOT_CONSTRUCTED_USE: return TO_STR(LIST_NOT_CONSTRUCTED_USE);
-        case LIST_DESTRUCTED_USE:      return TO_STR(LIST_DESTRUCTED_USE);
-        #endif
-
-        default: return NULL;
-    }
-
-    #undef TO_STR
-}
-
-//-----------------------------------------------------------------------------
-//! @param [in] list  
-//! 
-//! @return whether or not there are loops in list.
-//-----------------------------------------------------------------------------
-bool listNodesLoop(List* list)
-{
-    int currNode = list->head;
-    for (size_t i = 0; list->nodes[currNode].next != 0; i++)
-    {
-        if (i >= list->size - 1)
-        {
-            return true;
-        }
-
-        currNode = list->nodes[currNode].next;
-    }
+    if (idx >= list->freeWatermark) { return true; }
 
-    return false;
+    return (list->freeMap[idx / LIST_FREE_MAP_WORD_BITS] >> (idx % LIST_FREE_MAP_WORD_BITS)) & 1;
 }
 
 //-----------------------------------------------------------------------------
-//! @param [in] list  
-//! 
-//! @return whether or not there are loops the free list of list.
+//! @param [in] list   
+//! @param [in] word   
+//!
+//! @return word of list's free slots bitmap with the bits at or above list's
+//!         free watermark (which are stale) cleared.
 //-----------------------------------------------------------------------------
-bool listFreeLoop(List* list)
+uint64_t listFreeWord(List* list, size_t word)
 {
-    assert(list        != NULL);
-    assert(list->nodes != NULL);
+    assert(list          != NULL);
+    assert(list->freeMap != NULL);
 
-    size_t maxFreeCount = list->capacity - list->size - 1;
-    if (maxFreeCount == 0)
-    {
-        return false;
-    }
+    const size_t bits  = LIST_FREE_MAP_WORD_BITS;
+    size_t       first = word * bits;
 
-    int lastFree = list->free;
-    for (size_t i = 0; list->nodes[lastFree].next != 0; i++)
-    {
-        if (i >= maxFreeCount - 1)
-        {
-            return true;
-        }
+    if (first >= list->freeWatermark) { return 0; }
 
-        lastFree = list->nodes[lastFree].next;
-    }
+    if (list->freeWatermark - first >= bits) { return list->freeMap[word]; }
 
-    return false;
+    return list->freeMap[word] & (((uint64_t) 1 << (list->freeWatermark - first)) - 1);
 }
 
 //-----------------------------------------------------------------------------
-//! Resizes list's array to newCapacity. 
-//!
-//! @param [out]  list   
-//! @param [in]   newCapacity   
+//! Searches list's free slots bitmap below the free watermark a word at a 
+//! time from idx up and then from the beginning.
 //!
-//! @warning If newCapacity is less than list's size then there will be DATA 
-//!          LOSS!
-//!
-//! @warning If reallocation was unsuccessful, returns NULL and sets list's 
-//!          errorStatus to LIST_REALLOCATION_FAILED, but current elements of 
-//!          the list won't be removed.
+//! @param [in] list   
+//! @param [in] idx   
 //!
-//! @return pointer to the new list's array if reallocation was successful 
-//!         or NULL otherwise.
+//! @return first free slot below the watermark at or after idx, wrapping 
+//!         around, or 0 if there's none.
 //-----------------------------------------------------------------------------
-ListNode* resize(List* list, size_t newCapacity)
+size_t listFindFreeFrom(List* list, size_t idx)
 {
-    ASSERT_LIST_OK(list);
-    ListNode* newArray = NULL;
+    assert(list          != NULL);
+    assert(list->freeMap != NULL);
 
-    newArray = (ListNode*) ((char*) realloc((char*) list->nodes 
-                                                 
-                                            #ifdef LIST_CANARIES_ENABLED
-                                            - sizeof(LIST_ARRAY_CANARY_L)
-                                            #endif
+    const size_t bits  = LIST_FREE_MAP_WORD_BITS;
+    size_t       words = listFreeMapWords(list->freeWatermark);
+    size_t       word  = idx < list->freeWatermark ? idx / bits : 0;
 
-                                            , 
-                                            newCapacity * sizeof(ListNode) 
-                                            #ifdef LIST_CANARIES_ENABLED
-                                            + sizeof(LIST_ARRAY_CANARY_L) 
-                                            + sizeof(LIST_ARRAY_CANARY_R)
-                                            #endif
-                                           ) 
+    uint64_t current = idx < list->freeWatermark ? listFreeWord(list, word) & (~(uint64_t) 0 << (idx % bits)) : 0;
 
-                            #ifdef LIST_CANARIES_ENABLED
-                            + sizeof(LIST_ARRAY_CANARY_L)
-                            #endif  
-                           );
-
-    if (newArray == NULL)
-    {
-        setError(list, LIST_REALLOCATION_FAILED);
-    }
-    else
+    for (size_t i = 0; i <= words; i++)
     {
-        list->nodes    = newArray;
-        list->capacity = newCapacity;
+        if (current != 0) { return word * bits + LIST_CTZ(current); }
 
-        LIST_SET_CANARIES(list);
-        listUpdateFree(list, list->size + 1);
+        word    = word + 1 < words ? word + 1 : 0;
+        current = listFreeWord(list, word);
     }
 
-    list->searchEnabled = true;
-
-    ASSERT_LIST_OK(list);
-
-    return newArray;
+    return 0;
 }
 
 //-----------------------------------------------------------------------------
-//! Inserts value to list after node with index idx (indexing starts from 1). 
-//!
-//! @param [out] list   
-//! @param [in]  value   
-//! @param [in]  idx   
+//! Searches list's free slots bitmap below the free watermark a word at a 
+//! time, going further from idx in both directions.
 //!
-//! @note If idx = 0, then sets value as the first element in the list.
-//! @note Can call resize function if there are no free space left.
+//! @param [in] list   
+//! @param [in] idx   
 //!
-//! @return index at which value was inserted.
+//! @return free slot below the watermark closest to idx, the one after idx in
+//!         case of a tie, or 0 if there's none.
 //-----------------------------------------------------------------------------
-int insertAfter(List* list, list_elem_t value, size_t idx)
+size_t listFindFreeNear(List* list, size_t idx)
 {
-    ASSERT_LIST_OK(list);
-    assert(idx < list->capacity);
-    assert(list->nodes[idx].prev != -1);
-
-    if (list->size == list->capacity - 1)
-    {
-        ListNode* newArray = resize(list, list->capacity * LIST_EXPAND_MULTIPLIER);
+    assert(list          != NULL);
+    assert(list->freeMap != NULL);
 
-        if (newArray == NULL) { return 0; }
-    }
+    const size_t bits  = LIST_FREE_MAP_WORD_BITS;
+    size_t       words = listFreeMapWords(list->freeWatermark);
+    size_t       home  = idx / bits;
+    size_t       shift = idx % bits;
 
-    int newFree = list->nodes[list->free].next;
+    uint64_t after  = listFreeWord(list, home) & (~(uint64_t) 0 << shift);
+    uint64_t before = listFreeWord(list, home) & (((uint64_t) 1 << shift) - 1);
 
-    if (list->size == 0)
+    if (after != 0 || before != 0)
     {
-        list->nodes[list->free].prev = 0;
-        list->nodes[list->free].next = 0;
-        list->head = list->free;
-        list->tail = list->free;
-    }
-    else if (idx == list->tail)
-    {
-        list->nodes[list->free].next = 0;
-        list->nodes[list->free].prev = list->tail;
-        list->nodes[list->tail].next = list->free;
-        list->tail = list->free;
-    }
-    else if (idx == 0)
-    {
-        list->nodes[list->free].next = list->head;
-        list->nodes[list->free].prev = 0;
-        list->nodes[list->head].prev = list->free;
-        list->head = list->free;
-    }
-    else
-    {
-        list->nodes[list->free].next            = list->nodes[idx].next;
-        list->nodes[list->free].prev            = idx;
-        list->nodes[list->nodes[idx].next].prev = list->free;
-        list->nodes[idx].next                   = list->free;
-    }
+        size_t afterSlot  = after  != 0 ? home * bits + LIST_CTZ(after)              : 0;
+        size_t beforeSlot = before != 0 ? home * bits + bits - 1 - LIST_CLZ(before) : 0;
 
-    int insertedIndex = list->free;
+        if (before == 0)                                       { return afterSlot;  }
+        if (after  == 0 || idx - beforeSlot < afterSlot - idx) { return beforeSlot; }
 
-    list->nodes[list->free].value = value;
-    list->free = newFree;
-    list->size++;
+        return afterSlot;
+    }
 
-    list->searchEnabled = true;
+    for (size_t distance = 1; home + distance < words || home >= distance; distance++)
+    {
+        uint64_t next = home + distance < words ? listFreeWord(list, home + distance) : 0;
+        uint64_t prev = home >= distance        ? listFreeWord(list, home - distance) : 0;
 
-    ASSERT_LIST_OK(list);
+        if (next != 0) { return (home + distance) * bits + LIST_CTZ(next);            }
+        if (prev != 0) { return (home - distance) * bits + bits - 1 - LIST_CLZ(prev); }
+    }
 
-    return insertedIndex;
+    return 0;
 }
 
 //-----------------------------------------------------------------------------
-//! Inserts value to list before node with index idx (indexing starts from 1). 
+//! Pushes freed slot idx to list's stack of recently freed slots. The stack 
+//! is a ring, so the oldest slot is forgotten once it's full.
 //!
 //! @param [out] list   
-//! @param [in]  value   
 //! @param [in]  idx   
-//!
-//! @warning if idx = 0 then sets list's errorStatus to LIST_ACCESSING_ZERO and
-//!          returns 0.
-//! @note Can call resize function if there are no free space left.
-//!
-//! @return index at which value was inserted.
 //-----------------------------------------------------------------------------
-int insertBefore(List* list, list_elem_t value, size_t idx)
+void listPushFreed(List* list, size_t idx)
 {
-    ASSERT_LIST_OK(list);
-    assert(list->nodes[idx].prev != -1);
+    assert(list != NULL);
 
-    if (idx == 0)
-    {
-        setError(list, LIST_ACCESSING_ZERO);
-        return 0;
-    }
+    list->freedStack[list->freedStackTop] = idx;
+    list->freedStackTop = (list->freedStackTop + 1) % LIST_FREED_STACK_SIZE;
 
-    return insertAfter(list, value, list->nodes[idx].prev);
+    if (list->freedStackSize < LIST_FREED_STACK_SIZE) { list->freedStackSize++; }
 }
 
 //-----------------------------------------------------------------------------
-//! Returns element at idx in list (indexing starts from 1). 
+//! Pops slots from list's stack of recently freed slots until one of them 
+//! is still free. Slots get taken by other allocation policies or batch 
+//! rollbacks and the watermark drops below them on clear and linearization,
+//! all without touching the stack.
 //!
-//! @param [in] list   
-//! @param [in] idx   
+//! @param [out] list   
 //!
-//! @return element at idx.
+//! @return most recently freed slot that is still free or 0 if there's none.
 //-----------------------------------------------------------------------------
-list_elem_t at(List* list, size_t idx)
+size_t listPopFreed(List* list)
 {
-    ASSERT_LIST_OK(list);
-    assert(idx > 0 && idx < list->capacity);
-    assert(list->nodes[idx].prev != -1);
+    assert(list != NULL);
 
-    return list->nodes[idx].value;
+    while (list->freedStackSize > 0)
+    {
+        list->freedStackTop = (list->freedStackTop + LIST_FREED_STACK_SIZE - 1) % LIST_FREED_STACK_SIZE;
+        list->freedStackSize--;
+
+        size_t idx = list->freedStack[list->freedStackTop];
+
+        if (idx < list->freeWatermark && listIsFree(list, idx)) { return idx; }
+    }
+
+    return 0;
 }
 
 //-----------------------------------------------------------------------------
-//! Removes element at idx from list (indexing starts from 1). 
-//!
-//! @param [out] list   
-//! @param [in]  idx   
+//! @param [in] list   
 //!
-//! @return element removed.
+//! @return whether or not list's free slots bitmap (if there is one) marks 
+//!         exactly the slots unused by list.
 //-----------------------------------------------------------------------------
-list_elem_t remove(List* list, size_t idx)
+bool listFreeMapOk(List* list)
 {
-    ASSERT_LIST_OK(list);
-    assert(idx > 0 && idx < list->capacity);
-    assert(list->nodes[idx].prev != -1);
+    assert(list != NULL);
 
-    list_elem_t value = list->nodes[idx].value;
+    if (list->freeMap == NULL)                                            { return false; }
+    if (list->freeWatermark == 0 || list->freeWatermark > list->capacity) { return false; }
 
-    if (list->nodes[idx].prev != 0)
-    {
-        list->nodes[list->nodes[idx].prev].next = list->nodes[idx].next;
-    }
+    size_t words     = listFreeMapWords(list->freeWatermark);
+    size_t freeCount = list->capacity - list->freeWatermark;
 
-    if (list->nodes[idx].next != 0)
+    for (size_t i = 0; i < words; i++)
     {
-        list->nodes[list->nodes[idx].next].prev = list->nodes[idx].prev;
+        freeCount += LIST_POPCOUNT(listFreeWord(list, i));
     }
 
-    #ifdef LIST_POISONING_ENABLED
-    list->nodes[idx].value = LIST_POISON;
-    #endif
-
-    if (idx == list->head)
-    {
-        list->head = list->nodes[idx].next;
-    }
+    if (freeCount != list->capacity - list->size - 1) { return false; }
+    if (list->freeMap[0] & 1)                         { return false; }
 
-    if (idx == list->tail)
+    for (size_t index = list->head; index != 0; index = list->nodes[index].next)
     {
-        list->tail = list->nodes[idx].prev;
+        if (listIsFree(list, index)) { return false; }
     }
 
-    list->nodes[idx].prev = -1;
-    list->nodes[idx].next = list->free;
-    list->free            = idx;
-
-    list->size--;
-
-    list->searchEnabled = true;
-
-    ASSERT_LIST_OK(list);
-
-    return value;
+    return true;
 }
 
 //-----------------------------------------------------------------------------
-//! Empties the list. 
+//! Sets the way list's capacity grows when there's no free space left.
 //!
 //! @param [out] list   
+//! @param [in]  policy   
+//! @param [in]  parameter   multiplier (> 1) for LIST_GROWTH_GEOMETRIC, 
+//!              number of elements (>= 1) for LIST_GROWTH_FIXED_STEP. Page
+//!              aligned policies grow by LIST_EXPAND_MULTIPLIER and ignore 
+//!              parameter.
 //-----------------------------------------------------------------------------
-void clear(List* list)
+void setGrowthPolicy(List* list, ListGrowthPolicy policy, double parameter)
 {
     ASSERT_LIST_OK(list);
 
-    list->head          = 0;
-    list->tail          = 0;
-    list->free          = 1;
-    list->searchEnabled = true;
-    list->size          = 0;
-
-    #ifdef LIST_POISONING_ENABLED
-    list->nodes[0].value = LIST_POISON;
-    #endif
-
-    list->nodes[0].next  = 0;
-    list->nodes[0].prev  = 0;
-
-    listUpdateFree(list, 1);
+    list->growthPolicy = policy;
+    list->growthFactor = LIST_EXPAND_MULTIPLIER;
+    list->growthStep   = 0;
 
-    ASSERT_LIST_OK(list);
+    if (policy == LIST_GROWTH_GEOMETRIC)
+    {
+        assert(parameter > 1);
+        list->growthFactor = parameter;
+    }
+    else if (policy == LIST_GROWTH_FIXED_STEP)
+    {
+        assert(parameter >= 1);
+        list->growthStep = (size_t) parameter;
+    }
 }
 
 //-----------------------------------------------------------------------------
-//! Inserts value at the end of list. 
-//!
-//! @param [out] list   
-//! @param [in]  value    
-//!
-//! @note Can call resize function if there are no free space left.
+//! @param [in] list   
 //!
-//! @return index at which value was inserted.
+//! @return whether or not list is empty.
 //-----------------------------------------------------------------------------
-int pushBack(List* list, list_elem_t value)
+bool isEmpty(List* list)
 {
     ASSERT_LIST_OK(list);
 
-    return insertAfter(list, value, list->tail);
+    return list->size == 0;
 }
 
 //-----------------------------------------------------------------------------
-//! Inserts value at the beginning of list. 
-//!
-//! @param [out] list   
-//! @param [in]  value    
-//!
-//! @note Can call resize function if there are no free space left.
+//! @param [in] list   
 //!
-//! @return index at which value was inserted.
+//! @return current errorStatus of list.
 //-----------------------------------------------------------------------------
-int pushFront(List* list, list_elem_t value)
+uint32_t getErrorStatus(List* list)
 {
-    ASSERT_LIST_OK(list);
+    assert(list != NULL);
 
-    return insertAfter(list, value, 0);
+    return list->errorStatus;
 }
 
 //-----------------------------------------------------------------------------
-//! Removes the last element from list. 
+//! Adds error to list's errorStatus.
 //!
 //! @param [out] list   
-//!
-//! @return element removed.
+//! @param [in]  error   
 //-----------------------------------------------------------------------------
-list_elem_t popBack(List* list)
+void setError(List* list, ListError error)
 {
-    ASSERT_LIST_OK(list);
+    assert(list != NULL);
 
-    return remove(list, list->tail);
+    list->errorStatus |= error;
 }
 
+//----------------------------------------------------------------------------- 
+//! @param [in] error   
+//!    
+//! @return string representation of error (e.g. error = LIST_POP_FROM_EMPTY
+//!         returns "LIST_POP_FROM_EMPTY").   
 //-----------------------------------------------------------------------------
-//! Removes the first element from list. 
-//!
-//! @param [out] list   
-//!
-//! @return element removed.
-//-----------------------------------------------------------------------------
-list_elem_t popFront(List* list)
+const char* getErrorStr(ListError error)
 {
-    ASSERT_LIST_OK(list);
+    #define TO_STR(value) #value
+
+    switch (error)
+    {
+        case LIST_NO_ERROR:            return TO_STR(LIST_NO_ERROR);
+        case LIST_POP_FROM_EMPTY:      return TO_STR(LIST_POP_FROM_EMPTY);
+        case LIST_TOP_FROM_EMPTY:      return TO_STR(LIST_TOP_FROM_EMPTY);
+        case LIST_CONSTRUCTION_FAILED: return TO_STR(LIST_CONSTRUCTION_FAILED);
+        case LIST_REALLOCATION_FAILED: return TO_STR(LIST_REALLOCATION_FAILED);
+        case LIST_MEMORY_CORRUPTION:   return TO_STR(LIST_MEMORY_CORRUPTION);
+        case LIST_FREE_MAP_CORRUPTED:  return TO_STR(LIST_FREE_MAP_CORRUPTED);
+        case LIST_LOOP:                return TO_STR(LIST_LOOP);
+        case LIST_ACCESSING_ZERO:      return TO_STR(LIST_ACCESSING_ZERO);
+
+        #ifdef LIST_DEBUG_MODE
+        case LIST_NOT_CONSTRUCTED_USE: return TO_STR(LIST_NOT_CONSTRUCTED_USE);
+        case LIST_DESTRUCTED_USE:      return TO_STR(LIST_DESTRUCTED_USE);
+        #endif
+
+        default: return NULL;
+    }
+
+    #undef TO_STR
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] list  
+//! 
+//! @return whether or not there are loops in list.
+//-----------------------------------------------------------------------------
+bool listNodesLoop(List* list)
+{
+    int currNode = list->head;
+    for (size_t i = 0; list->nodes[currNode].next != 0; i++)
+    {
+        if (i >= list->size - 1)
+        {
+            return true;
+        }
+
+        currNode = list->nodes[currNode].next;
+    }
+
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+//! Resizes list's array to newCapacity. 
+//!
+//! @param [out]  list   
+//! @param [in]   newCapacity   
+//!
+//! @note Elements keep their indices, so a linearized list stays linearized.
+//!
+//! @warning If newCapacity is less than list's size then there will be DATA 
+//!          LOSS!
+//!
+//! @warning If reallocation was unsuccessful, returns NULL and sets list's 
+//!          errorStatus to LIST_REALLOCATION_FAILED, but current elements of 
+//!          the list won't be removed.
+//!
+//! @return pointer to the new list's array if reallocation was successful 
+//!         or NULL otherwise.
+//-----------------------------------------------------------------------------
+ListNode* resize(List* list, size_t newCapacity)
+{
+    ASSERT_LIST_OK(list);
+
+    LIST_PROFILE(list, LIST_PROFILE_RESIZE);
+
+    ListNode* newArray = listReallocNodes(list, newCapacity);
+
+    if (newArray == NULL)
+    {
+        setError(list, LIST_REALLOCATION_FAILED);
+    }
+    else
+    {
+        if (list->generations != NULL)
+        {
+            uint32_t* newGenerations = (uint32_t*) realloc(list->generations, newCapacity * sizeof(uint32_t));
+
+            if (newGenerations == NULL)
+            {
+                setError(list, LIST_REALLOCATION_FAILED);
+                return NULL;
+            }
+
+            if (newCapacity > list->capacity)
+            {
+                memset(newGenerations + list->capacity, 0, (newCapacity - list->capacity) * sizeof(uint32_t));
+            }
+
+            list->generations = newGenerations;
+        }
+
+        if (list->shared == NULL)
+        {
+            size_t    oldWords   = listFreeMapWords(list->capacity);
+            size_t    newWords   = listFreeMapWords(newCapacity);
+            uint64_t* newFreeMap = (uint64_t*) realloc(list->freeMap, newWords * sizeof(uint64_t));
+
+            if (newFreeMap == NULL)
+            {
+                setError(list, LIST_REALLOCATION_FAILED);
+                return NULL;
+            }
+
+            if (newWords > oldWords)
+            {
+                memset(newFreeMap + oldWords, 0, (newWords - oldWords) * sizeof(uint64_t));
+            }
+
+            list->freeMap = newFreeMap;
+        }
+
+        if (list->rankNodes != NULL)
+        {
+            ListRankNode* newRankNodes = (ListRankNode*) realloc(list->rankNodes, newCapacity * sizeof(ListRankNode));
+
+            if (newRankNodes == NULL)
+            {
+                setError(list, LIST_REALLOCATION_FAILED);
+                return NULL;
+            }
+
+            list->rankNodes = newRankNodes;
+        }
+
+        if (list->chainLinks != NULL)
+        {
+            size_t    extraChains   = list->chainsCount - 1;
+            ListLink* newChainLinks = (ListLink*) realloc(list->chainLinks, newCapacity * extraChains * sizeof(ListLink));
+
+            if (newChainLinks == NULL)
+            {
+                setError(list, LIST_REALLOCATION_FAILED);
+                return NULL;
+            }
+
+            list->chainLinks = newChainLinks;
+        }
+
+        size_t oldCapacity = list->capacity;
+        list->capacity     = newCapacity;
+
+        LIST_SET_CANARIES(list);
+        listUpdateFree(list, oldCapacity);
+
+        if (list->epochs != NULL) { list->epochs->capacity.store(newCapacity); }
+
+        if (list->snapshotChunks != NULL) { listSnapshotResize(list, oldCapacity); }
+
+        if (list->hashTable != NULL)
+        {
+            int* newChain = (int*) realloc(list->hashChain, newCapacity * sizeof(int));
+
+            if (newChain == NULL)
+            {
+                setError(list, LIST_REALLOCATION_FAILED);
+                return NULL;
+            }
+
+            list->hashChain = newChain;
+
+            if (!listHashRebuild(list)) { return NULL; }
+        }
+    }
+
+    ASSERT_LIST_OK(list);
+
+    return newArray;
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] capacity   
+//!
+//! @return size in bytes of the memory block holding capacity nodes, their
+//!         canaries and the padding needed to align the nodes.
+//-----------------------------------------------------------------------------
+size_t listNodesBytes(size_t capacity)
+{
+    return capacity * sizeof(ListNode) + LIST_NODES_ALIGNMENT - 1
+
+           #ifdef LIST_CANARIES_ENABLED
+           + sizeof(LIST_ARRAY_CANARY_L) 
+           + sizeof(LIST_ARRAY_CANARY_R) 
+           #endif 
+           ;
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] block   memory block of listNodesBytes size
+//!
+//! @return pointer to the first node in block. It is aligned to 
+//!         LIST_NODES_ALIGNMENT and leaves room for the left canary.
+//-----------------------------------------------------------------------------
+ListNode* listAlignNodes(void* block)
+{
+    uintptr_t address = (uintptr_t) block;
+
+    #ifdef LIST_CANARIES_ENABLED
+    address += sizeof(LIST_ARRAY_CANARY_L);
+    #endif
+
+    address = (address + LIST_NODES_ALIGNMENT - 1) / LIST_NODES_ALIGNMENT * LIST_NODES_ALIGNMENT;
+
+    return (ListNode*) address;
+}
+
+//-----------------------------------------------------------------------------
+//! Makes from's buffers to's and resets from to a not constructed list.
+//!
+//! @param [out] to   
+//! @param [out] from   
+//-----------------------------------------------------------------------------
+void listMove(List* to, List* from)
+{
+    assert(to   != NULL);
+    assert(from != NULL);
+
+    memcpy((void*) to, (const void*) from, sizeof(List));
+
+    new (from) List();
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in]  array   can be NULL
+//! @param [in]  bytes   
+//! @param [out] failed   set to true if the copy couldn't be allocated
+//!
+//! @return newly allocated copy of array or NULL if array is NULL.
+//-----------------------------------------------------------------------------
+void* listCloneArray(const void* array, size_t bytes, bool* failed)
+{
+    assert(failed != NULL);
+
+    if (array == NULL) { return NULL; }
+
+    void* copy = malloc(bytes > 0 ? bytes : 1);
+
+    if (copy == NULL)
+    {
+        *failed = true;
+        return NULL;
+    }
+
+    memcpy(copy, array, bytes);
+
+    return copy;
+}
+
+//-----------------------------------------------------------------------------
+//! Allocates zeroed memory for capacity nodes aligned to cache lines.
+//!
+//! @param [in]  capacity   
+//! @param [out] block   set to the allocated memory block, which is the one
+//!              to be freed
+//!
+//! @return pointer to the first node or NULL if calloc returned NULL.
+//-----------------------------------------------------------------------------
+ListNode* listAllocNodes(size_t capacity, void** block)
+{
+    assert(block != NULL);
+
+    *block = calloc(1, listNodesBytes(capacity));
+    if (*block == NULL) { return NULL; }
+
+    return listAlignNodes(*block);
+}
+
+//-----------------------------------------------------------------------------
+//! Reallocates list's nodes keeping them aligned to cache lines. If realloc
+//! moved the block to an address with a different alignment, the nodes are 
+//! moved within the new block.
+//!
+//! @param [out] list   
+//! @param [in]  newCapacity   
+//!
+//! @note Updates list's nodes and nodesBlock, but not its capacity.
+//! @note If concurrent reads are enabled, the nodes are copied to a new block
+//!       and the old one is retired instead.
+//! @note Nodes of a shared list are grown in its shared memory object, which
+//!       moves the free slots bitmap as well.
+//!
+//! @return pointer to the first node or NULL if realloc returned NULL.
+//-----------------------------------------------------------------------------
+ListNode* listReallocNodes(List* list, size_t newCapacity)
+{
+    assert(list != NULL);
+
+    #ifdef LIST_SHARED_MEMORY_ENABLED
+    if (list->shared != NULL) { return listSharedResize(list, newCapacity); }
+    #endif
+
+    if (list->epochs != NULL)
+    {
+        void*     newBlock = NULL;
+        ListNode* newNodes = listAllocNodes(newCapacity, &newBlock);
+
+        if (newNodes == NULL) { return NULL; }
+
+        size_t copied = list->capacity < newCapacity ? list->capacity : newCapacity;
+        memcpy(newNodes, list->nodes, copied * sizeof(ListNode));
+
+        void* oldBlock   = list->nodesBlock;
+        list->nodes      = newNodes;
+        list->nodesBlock = newBlock;
+
+        listEpochRetire(list, oldBlock);
+
+        return newNodes;
+    }
+
+    size_t oldOffset = (char*) list->nodes - (char*) list->nodesBlock;
+    void*  newBlock  = realloc(list->nodesBlock, listNodesBytes(newCapacity));
+
+    if (newBlock == NULL) { return NULL; }
+
+    ListNode* newNodes = listAlignNodes(newBlock);
+
+    if ((size_t) ((char*) newNodes - (char*) newBlock) != oldOffset)
+    {
+        size_t moved = list->capacity < newCapacity ? list->capacity : newCapacity;
+        memmove(newNodes, (char*) newBlock + oldOffset, moved * sizeof(ListNode));
+    }
+
+    list->nodes      = newNodes;
+    list->nodesBlock = newBlock;
+
+    return newNodes;
+}
+
+//-----------------------------------------------------------------------------
+//! Takes a free slot for an element to be inserted after idx. 
+//!
+//! @param [out] list   
+//! @param [in]  idx   
+//!
+//! @note With LIST_ALLOCATION_LIFO the most recently freed slot is taken, 
+//!       as long as it's among the last LIST_FREED_STACK_SIZE ones. Then 
+//!       slots above the free watermark are taken one by one.
+//! @note With LIST_ALLOCATION_BLOCKED a free slot sharing a cache line with 
+//!       idx or with the element following it (if any) is preferred.
+//! @note With LIST_ALLOCATION_NEAREST the free slot physically closest to 
+//!       idx is taken, the watermark slot included.
+//!
+//! @return taken slot.
+//-----------------------------------------------------------------------------
+size_t listTakeFree(List* list, size_t idx)
+{
+    assert(list != NULL);
+
+    size_t taken     = 0;
+    size_t watermark = list->freeWatermark < list->capacity ? list->freeWatermark : 0;
+
+    if (list->allocationPolicy == LIST_ALLOCATION_LIFO)
+    {
+        taken = listPopFreed(list);
+    }
+    else if (list->allocationPolicy == LIST_ALLOCATION_NEAREST)
+    {
+        size_t near = idx == 0 ? list->head : idx;
+        taken       = listFindFreeNear(list, near);
+
+        if (watermark != 0 && (taken == 0 || watermark - near < (taken > near ? taken - near : near - taken)))
+        {
+            taken = watermark;
+        }
+    }
+    else if (list->allocationPolicy == LIST_ALLOCATION_BLOCKED && list->size > 0)
+    {
+        const size_t nodesPerLine = LIST_NODES_ALIGNMENT / sizeof(ListNode);
+        const size_t lineMask     = ((uint64_t) 1 << nodesPerLine) - 1;
+
+        size_t neighbour = idx == 0 ? list->head : list->nodes[idx].next;
+        size_t lines[]   = {(idx != 0 ? idx : neighbour) / nodesPerLine, neighbour / nodesPerLine};
+
+        // after the tail there is no following element to be near to
+        size_t linesCount = neighbour != 0 ? 2 : 1;
+
+        for (size_t i = 0; i < linesCount && taken == 0; i++)
+        {
+            size_t   first    = lines[i] * nodesPerLine;
+            uint64_t lineFree = (listFreeWord(list, first / LIST_FREE_MAP_WORD_BITS) >> 
+                                 (first % LIST_FREE_MAP_WORD_BITS)) & lineMask;
+
+            if (lineFree != 0) { taken = first + LIST_CTZ(lineFree); }
+        }
+    }
+
+    if (taken == 0) { taken = watermark; }
+    if (taken == 0) { taken = listFindFreeFrom(list, list->free); }
+
+    assert(taken != 0);
+
+    listFreeMapSet(list, taken, false);
+    list->free = taken;
+
+    if (taken == list->freeWatermark) { list->freeWatermark++; }
+
+    return taken;
+}
+
+//-----------------------------------------------------------------------------
+//! Rounds capacity up, so that the nodes buffer fills a whole allocator size 
+//! class (or a whole number of pages for page aligned policies). This way 
+//! realloc is more likely to grow the buffer in place.
+//!
+//! @param [in] list   
+//! @param [in] capacity   
+//!
+//! @note Size classes are the ones of common malloc implementations: four 
+//!       classes per power of two and whole pages (minus the chunk header) 
+//!       for buffers big enough to be mmap'ed.
+//!
+//! @return rounded capacity.
+//-----------------------------------------------------------------------------
+size_t listRoundCapacity(List* list, size_t capacity)
+{
+    assert(list != NULL);
+
+    size_t bytes     = listNodesBytes(capacity);
+    size_t extra     = 0;
+    size_t alignment = 0;
+
+    switch (list->growthPolicy)
+    {
+        case LIST_GROWTH_PAGE_ALIGNED:      alignment = LIST_PAGE_SIZE;      break;
+        case LIST_GROWTH_HUGE_PAGE_ALIGNED: alignment = LIST_HUGE_PAGE_SIZE; break;
+
+        default:
+        {
+            if (bytes >= LIST_MMAP_THRESHOLD)
+            {
+                alignment = LIST_PAGE_SIZE;
+                extra     = LIST_MALLOC_OVERHEAD;
+            }
+            else
+            {
+                alignment = sizeof(ListNode);
+                while (alignment * 8 <= bytes) { alignment *= 2; }
+            }
+
+            break;
+        }
+    }
+
+    size_t rounded = (bytes + extra + alignment - 1) / alignment * alignment - extra;
+
+    return capacity + (rounded - bytes) / sizeof(ListNode);
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] list   
+//!
+//! @return capacity list should grow to when there's no free space left.
+//-----------------------------------------------------------------------------
+size_t listGrowCapacity(List* list)
+{
+    assert(list != NULL);
+
+    size_t newCapacity = list->growthPolicy == LIST_GROWTH_FIXED_STEP ? list->capacity + list->growthStep 
+                                                                      : list->capacity * list->growthFactor;
+
+    if (newCapacity <= list->capacity) { newCapacity = list->capacity + 1; }
+
+    return listRoundCapacity(list, newCapacity);
+}
+
+//-----------------------------------------------------------------------------
+//! Inserts value to list after node with index idx (indexing starts from 1). 
+//!
+//! @param [out] list   
+//! @param [in]  value   
+//! @param [in]  idx   
+//!
+//! @note If idx = 0, then sets value as the first element in the list.
+//! @note Can call resize function if there are no free space left.
+//! @note During a batch, if the undo log can't grow then nothing is inserted
+//!       and list's errorStatus is set to LIST_REALLOCATION_FAILED.
+//!
+//! @return index at which value was inserted or 0 if it wasn't.
+//-----------------------------------------------------------------------------
+int insertAfter(List* list, list_elem_t value, size_t idx)
+{
+    ASSERT_LIST_OK(list);
+    assert(idx < list->capacity);
+    assert(!listIsFree(list, idx));
+
+    LIST_PROFILE(list, LIST_PROFILE_INSERT);
+
+    if (list->batch != NULL && !listBatchGrow(list)) { return 0; }
+
+    bool appends = idx == list->tail && (!list->searchEnabled || list->size == 0);
+
+    if (list->size == list->capacity - 1)
+    {
+        ListNode* newArray = resize(list, listGrowCapacity(list));
+
+        if (newArray == NULL) { return 0; }
+    }
+
+    size_t freeHint      = list->free;
+    size_t insertedIndex = listTakeFree(list, idx);
+
+    if (list->size == 0)
+    {
+        list->nodes[insertedIndex].prev = 0;
+        list->nodes[insertedIndex].next = 0;
+        listSetHead(list, insertedIndex);
+        list->tail = insertedIndex;
+    }
+    else if (idx == list->tail)
+    {
+        list->nodes[insertedIndex].next = 0;
+        list->nodes[insertedIndex].prev = list->tail;
+        list->nodes[list->tail].next    = insertedIndex;
+        list->tail = insertedIndex;
+    }
+    else if (idx == 0)
+    {
+        list->nodes[insertedIndex].next = list->head;
+        list->nodes[insertedIndex].prev = 0;
+        list->nodes[list->head].prev    = insertedIndex;
+        listSetHead(list, insertedIndex);
+    }
+    else
+    {
+        list->nodes[insertedIndex].next         = list->nodes[idx].next;
+        list->nodes[insertedIndex].prev         = idx;
+        list->nodes[list->nodes[idx].next].prev = insertedIndex;
+        list->nodes[idx].next                   = insertedIndex;
+    }
+
+    list->nodes[insertedIndex].value = value;
+    list->size++;
+
+    for (size_t chain = 1; chain < list->chainsCount; chain++)
+    {
+        listChainLinkAfter(list, insertedIndex, listChainLink(list, 0, chain)->prev, chain);
+    }
+
+    if (list->snapshotChunks != NULL)
+    {
+        listSnapshotTouch(list, insertedIndex);
+        listSnapshotTouch(list, list->nodes[insertedIndex].prev);
+        listSnapshotTouch(list, list->nodes[insertedIndex].next);
+    }
+
+    if (list->hashTable != NULL) { listHashInsert(list, insertedIndex); }
+    if (list->rankNodes != NULL) { listRankInsert(list, insertedIndex, idx); }
+    if (list->batch     != NULL) { listBatchLog(list, insertedIndex, true, freeHint); }
+
+    // appending to a linearized (or empty) list right after its last slot 
+    // keeps it linearized
+    list->searchEnabled = !appends || insertedIndex != list->size;
+
+    ASSERT_LIST_OK(list);
+
+    return insertedIndex;
+}
+
+//-----------------------------------------------------------------------------
+//! Inserts value to list before node with index idx (indexing starts from 1). 
+//!
+//! @param [out] list   
+//! @param [in]  value   
+//! @param [in]  idx   
+//!
+//! @warning if idx = 0 then sets list's errorStatus to LIST_ACCESSING_ZERO and
+//!          returns 0.
+//! @note Can call resize function if there are no free space left.
+//!
+//! @return index at which value was inserted.
+//-----------------------------------------------------------------------------
+int insertBefore(List* list, list_elem_t value, size_t idx)
+{
+    ASSERT_LIST_OK(list);
+    assert(!listIsFree(list, idx));
+
+    if (idx == 0)
+    {
+        setError(list, LIST_ACCESSING_ZERO);
+        return 0;
+    }
+
+    return insertAfter(list, value, list->nodes[idx].prev);
+}
+
+//-----------------------------------------------------------------------------
+//! Returns element at idx in list (indexing starts from 1). 
+//!
+//! @param [in] list   
+//! @param [in] idx   
+//!
+//! @return element at idx.
+//-----------------------------------------------------------------------------
+list_elem_t at(List* list, size_t idx)
+{
+    ASSERT_LIST_OK(list);
+    assert(idx > 0 && idx < list->capacity);
+    assert(!listIsFree(list, idx));
+
+    return list->nodes[idx].value;
+}
+
+//-----------------------------------------------------------------------------
+//! Removes element at idx from list (indexing starts from 1). 
+//!
+//! @param [out] list   
+//! @param [in]  idx   
+//!
+//! @note During a batch, if the undo log can't grow then nothing is removed,
+//!       list's errorStatus is set to LIST_REALLOCATION_FAILED and 0 is 
+//!       returned.
+//!
+//! @return element removed.
+//-----------------------------------------------------------------------------
+list_elem_t remove(List* list, size_t idx)
+{
+    ASSERT_LIST_OK(list);
+    assert(idx > 0 && idx < list->capacity);
+    assert(!listIsFree(list, idx));
+
+    LIST_PROFILE(list, LIST_PROFILE_REMOVE);
+
+    if (list->batch != NULL && !listBatchGrow(list)) { return 0; }
+
+    list_elem_t value = list->nodes[idx].value;
+
+    if (list->hashTable != NULL) { listHashRemove(list, idx); }
+    if (list->rankNodes != NULL) { listRankRemove(list, idx); }
+    if (list->batch     != NULL) { listBatchLog(list, idx, false, list->free); }
+
+    if (list->snapshotChunks != NULL)
+    {
+        listSnapshotTouch(list, list->nodes[idx].prev);
+        listSnapshotTouch(list, list->nodes[idx].next);
+    }
+
+    for (size_t chain = 1; chain < list->chainsCount; chain++)
+    {
+        listChainUnlink(list, idx, chain);
+    }
+
+    if (list->nodes[idx].prev != 0)
+    {
+        list->nodes[list->nodes[idx].prev].next = list->nodes[idx].next;
+    }
+
+    if (list->nodes[idx].next != 0)
+    {
+        list->nodes[list->nodes[idx].next].prev = list->nodes[idx].prev;
+    }
+
+    #ifdef LIST_POISONING_ENABLED
+    list->nodes[idx].value = LIST_POISON;
+    #endif
+
+    if (idx == list->head)
+    {
+        listSetHead(list, list->nodes[idx].next);
+    }
+
+    if (idx == list->tail)
+    {
+        list->tail = list->nodes[idx].prev;
+    }
+
+    listFreeMapSet(list, idx, true);
+    listPushFreed (list, idx);
+    list->free = idx;
+
+    if (list->generations != NULL) { list->generations[idx]++; }
+
+    list->size--;
+
+    list->searchEnabled = true;
+
+    ASSERT_LIST_OK(list);
+
+    return value;
+}
+
+//-----------------------------------------------------------------------------
+//! Empties the list. 
+//!
+//! @param [out] list   
+//!
+//! @note Works in O(1): the whole buffer just gets above list's free 
+//!       watermark. Generations of the elements and the hash index (if they
+//!       are enabled) and LIST_POISONING_ENABLED make it O(size) or 
+//!       O(capacity) though.
+//-----------------------------------------------------------------------------
+void clear(List* list)
+{
+    ASSERT_LIST_OK(list);
+    assert(list->batch == NULL);
+
+    if (list->generations != NULL)
+    {
+        for (size_t index = list->head; index != 0; index = list->nodes[index].next)
+        {
+            list->generations[index]++;
+        }
+    }
+
+    listSetHead(list, 0);
+    list->tail          = 0;
+    list->free          = 0;
+    list->searchEnabled = true;
+    list->size          = 0;
+
+    #ifdef LIST_POISONING_ENABLED
+    list->nodes[0].value = LIST_POISON;
+    #endif
+
+    list->nodes[0].next  = 0;
+    list->nodes[0].prev  = 0;
+
+    for (size_t chain = 1; chain < list->chainsCount; chain++)
+    {
+        *listChainLink(list, 0, chain) = {};
+    }
+
+    listUpdateFree(list, 1);
+
+    if (list->hashTable != NULL)
+    {
+        memset(list->hashTable, 0, list->hashTableSize * sizeof(int));
+    }
+
+    list->rankRoot = 0;
+
+    ASSERT_LIST_OK(list);
+}
+
+//-----------------------------------------------------------------------------
+//! Inserts value at the end of list. 
+//!
+//! @param [out] list   
+//! @param [in]  value    
+//!
+//! @note Can call resize function if there are no free space left.
+//!
+//! @return index at which value was inserted.
+//-----------------------------------------------------------------------------
+int pushBack(List* list, list_elem_t value)
+{
+    ASSERT_LIST_OK(list);
+
+    return insertAfter(list, value, list->tail);
+}
+
+//-----------------------------------------------------------------------------
+//! Inserts value at the beginning of list. 
+//!
+//! @param [out] list   
+//! @param [in]  value    
+//!
+//! @note Can call resize function if there are no free space left.
+//!
+//! @return index at which value was inserted.
+//-----------------------------------------------------------------------------
+int pushFront(List* list, list_elem_t value)
+{
+    ASSERT_LIST_OK(list);
+
+    return insertAfter(list, value, 0);
+}
+
+//-----------------------------------------------------------------------------
+//! Removes the last element from list. 
+//!
+//! @param [out] list   
+//!
+//! @return element removed.
+//-----------------------------------------------------------------------------
+list_elem_t popBack(List* list)
+{
+    ASSERT_LIST_OK(list);
+
+    return remove(list, list->tail);
+}
+
+//-----------------------------------------------------------------------------
+//! Removes the first element from list. 
+//!
+//! @param [out] list   
+//!
+//! @return element removed.
+//-----------------------------------------------------------------------------
+list_elem_t popFront(List* list)
+{
+    ASSERT_LIST_OK(list);
 
     return remove(list, list->head);
 }
@@ -869,61 +2106,3281 @@ list_elem_t popFront(List* list)
 //-----------------------------------------------------------------------------
 //! @param [out] list   
 //!
-//! @return the last element in list.
+//! @return the last element in list.
+//-----------------------------------------------------------------------------
+list_elem_t topBack(List* list)
+{
+    ASSERT_LIST_OK(list);
+
+    return at(list, list->tail);
+}
+
+//-----------------------------------------------------------------------------
+//! @param [out] list   
+//!
+//! @return the first element in list.
+//-----------------------------------------------------------------------------
+list_elem_t topFront(List* list)
+{
+    ASSERT_LIST_OK(list);
+
+    return at(list, list->head);
+}
+
+//-----------------------------------------------------------------------------
+//! Finds index and position of the first element with this value in list.
+//! 
+//! @param [in]  list   
+//! @param [in]  value   
+//! @param [out] idx   will be set to the index of the found element (starting 
+//!              from 1) or 0 in case there no such elements in the list.    
+//! @param [out] pos   will be set to the position of the found element (starting 
+//!              from 1) or 0 in case there no such elements in the list. Can 
+//!              be NULL if position isn't needed.
+//!
+//! @note With hash index enabled a missing value is reported in O(1). So is a
+//!       found one, unless its position has to be computed or there are 
+//!       several elements with this value and the list isn't linearized.
+//!
+//! @return whether or not element with this value has been found.
+//-----------------------------------------------------------------------------
+bool find(List* list, list_elem_t value, int* idx, int* pos)
+{
+    ASSERT_LIST_OK(list);
+
+    LIST_PROFILE(list, LIST_PROFILE_FIND);
+
+    if (list->hashTable != NULL)
+    {
+        size_t slot  = listHashLookup(list, value);
+        int    first = list->hashTable[slot];
+
+        if (first == 0)
+        {
+            *idx = 0;
+            if (pos != NULL) { *pos = 0; }
+
+            return false;
+        }
+
+        if (list->hashChain[first] == 0 || !list->searchEnabled)
+        {
+            // if linearized, the first element is the one with the least index
+            for (int index = list->hashChain[first]; index != 0; index = list->hashChain[index])
+            {
+                if (index < first) { first = index; }
+            }
+
+            *idx = first;
+            if (pos != NULL) { *pos = listPosOf(list, first); }
+
+            return true;
+        }
+    }
+
+    if (list->twoEndedSearch) { return listFindTwoEnded(list, value, idx, pos); }
+
+    int index = list->head;
+    for (size_t i = 1; i <= list->size; i++)
+    {
+        if (list->nodes[index].value == value)
+        {
+            *idx = index;
+            if (pos != NULL) { *pos = i; }
+
+            return true;
+        }
+
+        index = list->nodes[index].next;
+    }
+
+    *idx = 0;
+    if (pos != NULL) { *pos = 0; }
+
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+//! Same as find's linear search, but walks the list from both ends at once.
+//! Two independent chains of loads let the cache misses of one overlap with
+//! the other's, and each side walks at most half of the list.
+//!
+//! @note Nothing is prefetched: a node's address is known only once the 
+//!       previous node is loaded, which is when the walk loads it anyway.
+//!
+//! @param [in]  list   
+//! @param [in]  value   
+//! @param [out] idx   
+//! @param [out] pos   can be NULL
+//!
+//! @return whether or not element with this value has been found.
+//-----------------------------------------------------------------------------
+bool listFindTwoEnded(List* list, list_elem_t value, int* idx, int* pos)
+{
+    assert(list != NULL);
+    assert(idx  != NULL);
+
+    size_t front     = list->head;
+    size_t back      = list->tail;
+    size_t foundBack = 0;
+    size_t foundPos  = 0;
+
+    for (size_t i = 1, j = list->size; i <= j; i++, j--)
+    {
+        if (list->nodes[front].value == value)
+        {
+            *idx = front;
+            if (pos != NULL) { *pos = i; }
+
+            return true;
+        }
+
+        // the closest to the middle match from the back is the first one
+        if (list->nodes[back].value == value)
+        {
+            foundBack = back;
+            foundPos  = j;
+        }
+
+        front = list->nodes[front].next;
+        back  = list->nodes[back].prev;
+    }
+
+    *idx = foundBack;
+    if (pos != NULL) { *pos = foundPos; }
+
+    return foundBack != 0;
+}
+
+//-----------------------------------------------------------------------------
+//! Enables or disables two-ended traversal of list. When enabled, find, 
+//! LIST_SLOW::findPos and LIST_SLOW::switchToIndexSearch walk the list from
+//! both ends at once, so that the cache misses of the two walks overlap.
+//!
+//! @param [out] list   
+//! @param [in]  enabled   
+//!
+//! @note Pays off on big lists scattered over the buffer, where every step
+//!       is a cache miss. LIST_SLOW::findIndex always walks from the end
+//!       closest to the position, which is as short as two-ended walking.
+//-----------------------------------------------------------------------------
+void setTwoEndedSearch(List* list, bool enabled)
+{
+    ASSERT_LIST_OK(list);
+
+    list->twoEndedSearch = enabled;
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] list   
+//! @param [in] idx   index of an element in list
+//!
+//! @return position of the element at idx, using the fastest way available.
+//-----------------------------------------------------------------------------
+int listPosOf(List* list, size_t idx)
+{
+    assert(list != NULL);
+
+    if (!list->searchEnabled) { return idx; }
+
+    return LIST_SLOW::findPos(list, idx);
+}
+
+//-----------------------------------------------------------------------------
+//! Inserts value into list sorted in ascending order, after all the elements
+//! equal to it, so that equal elements stay in the order of insertion.
+//!
+//! @param [out] list   sorted list
+//! @param [in]  value   
+//!
+//! @note Finding the place takes O(log(n)) if list is linearized or its 
+//!       rank index is enabled and O(n) otherwise. Inserting at the back of
+//!       a linearized list keeps it linearized.
+//!
+//! @return index at which value was inserted.
+//-----------------------------------------------------------------------------
+int insertSorted(List* list, list_elem_t value)
+{
+    ASSERT_LIST_OK(list);
+
+    size_t bound = listBound(list, value, true);
+
+    if (bound == 0) { return insertAfter(list, value, list->tail); }
+
+    return insertBefore(list, value, bound);
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] list    sorted list
+//! @param [in] value   
+//!
+//! @note Takes O(log(n)) if list is linearized or its rank index is enabled
+//!       and O(n) otherwise.
+//!
+//! @return index of the first element that isn't less than value or 0 if 
+//!         there is no such element.
+//-----------------------------------------------------------------------------
+int lowerBound(List* list, list_elem_t value)
+{
+    ASSERT_LIST_OK(list);
+
+    return listBound(list, value, false);
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] list    sorted list
+//! @param [in] value   
+//!
+//! @note Takes O(log(n)) if list is linearized or its rank index is enabled
+//!       and O(n) otherwise.
+//!
+//! @return index of the first element that is greater than value or 0 if 
+//!         there is no such element.
+//-----------------------------------------------------------------------------
+int upperBound(List* list, list_elem_t value)
+{
+    ASSERT_LIST_OK(list);
+
+    return listBound(list, value, true);
+}
+
+//-----------------------------------------------------------------------------
+//! Appends count values sorted in ascending order to the back of list in 
+//! O(n + count). The rank index, if enabled, is rebuilt once at the end 
+//! instead of being updated on every insertion.
+//!
+//! @param [out] list   sorted list
+//! @param [in]  values   none of them may be less than list's last element
+//! @param [in]  count   
+//!
+//! @note If list is linearized or empty and its free slots are all after
+//!       its elements, it ends up linearized.
+//!
+//! @return whether or not all the values were appended.
+//-----------------------------------------------------------------------------
+bool loadSorted(List* list, const list_elem_t* values, size_t count)
+{
+    ASSERT_LIST_OK(list);
+    assert(list->batch == NULL);
+    assert(values != NULL || count == 0);
+
+    if (!reserve(list, list->size + count)) { return false; }
+
+    // the rank index is rebuilt in O(n) instead
+    ListRankNode* rankNodes = list->rankNodes;
+    list->rankNodes = NULL;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        assert(list->size == 0 || !(values[i] < list->nodes[list->tail].value));
+
+        insertAfter(list, values[i], list->tail);
+    }
+
+    list->rankNodes = rankNodes;
+    if (list->rankNodes != NULL) { listRankRebuild(list); }
+
+    ASSERT_LIST_OK(list);
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//! Finds the first element of sorted list that is greater than value 
+//! (upper) or isn't less than it (!upper). A linearized list is binary 
+//! searched by index. With the rank index, its treap is ordered by position 
+//! and therefore by value too, so it's searched from the root.
+//!
+//! @param [in] list    sorted list
+//! @param [in] value   
+//! @param [in] upper   
+//!
+//! @return index of the found element or 0 if there is no such element.
+//-----------------------------------------------------------------------------
+size_t listBound(List* list, list_elem_t value, bool upper)
+{
+    assert(list != NULL);
+
+    #ifdef LIST_DEBUG_MODE
+    assert(listSortedOk(list));
+    #endif
+
+    #define LIST_BOUND_AFTER(element) (upper ? value < (element) : !((element) < value))
+
+    if (!list->searchEnabled)
+    {
+        size_t first = 1;
+        size_t last  = list->size + 1;
+
+        while (first < last)
+        {
+            size_t middle = first + (last - first) / 2;
+
+            if (LIST_BOUND_AFTER(list->nodes[middle].value)) { last  = middle;     }
+            else                                             { first = middle + 1; }
+        }
+
+        return first <= list->size ? first : 0;
+    }
+
+    if (list->rankNodes != NULL)
+    {
+        size_t bound = 0;
+        size_t node  = list->rankRoot;
+
+        while (node != 0)
+        {
+            if (LIST_BOUND_AFTER(list->nodes[node].value))
+            {
+                bound = node;
+                node  = list->rankNodes[node].left;
+            }
+            else
+            {
+                node = list->rankNodes[node].right;
+            }
+        }
+
+        return bound;
+    }
+
+    size_t index = list->head;
+    while (index != 0 && !LIST_BOUND_AFTER(list->nodes[index].value))
+    {
+        index = list->nodes[index].next;
+    }
+
+    #undef LIST_BOUND_AFTER
+
+    return index;
+}
+
+#ifdef LIST_DEBUG_MODE
+//-----------------------------------------------------------------------------
+//! @param [in] list   
+//!
+//! @return whether or not list is sorted in ascending order.
+//-----------------------------------------------------------------------------
+bool listSortedOk(List* list)
+{
+    assert(list != NULL);
+
+    for (size_t index = list->head; index != 0 && list->nodes[index].next != 0; index = list->nodes[index].next)
+    {
+        if (list->nodes[list->nodes[index].next].value < list->nodes[index].value) { return false; }
+    }
+
+    return true;
+}
+#endif
+
+//-----------------------------------------------------------------------------
+//! @param [in] value   
+//!
+//! @return hash of value, equal values (including 0 and -0) have equal hashes.
+//-----------------------------------------------------------------------------
+size_t listHashValue(list_elem_t value)
+{
+    if (value == 0) { value = 0; }
+
+    uint64_t bits = 0;
+    memcpy(&bits, &value, sizeof(bits));
+
+    bits ^= bits >> 33;
+    bits *= 0xFF51AFD7ED558CCDull;
+    bits ^= bits >> 33;
+    bits *= 0xC4CEB9FE1A85EC53ull;
+    bits ^= bits >> 33;
+
+    return (size_t) bits;
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] list   
+//! @param [in] value   
+//!
+//! @return slot of list's hash table holding elements with this value or the
+//!         empty slot where they would be placed.
+//-----------------------------------------------------------------------------
+size_t listHashLookup(List* list, list_elem_t value)
+{
+    assert(list            != NULL);
+    assert(list->hashTable != NULL);
+
+    size_t mask = list->hashTableSize - 1;
+    size_t slot = listHashValue(value) & mask;
+
+    while (list->hashTable[slot] != 0 && !(list->nodes[list->hashTable[slot]].value == value))
+    {
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+//-----------------------------------------------------------------------------
+//! Adds element at idx to list's hash index.
+//!
+//! @param [out] list   
+//! @param [in]  idx   
+//!
+//! @note NaN values are never equal to anything, so they aren't indexed.
+//-----------------------------------------------------------------------------
+void listHashInsert(List* list, size_t idx)
+{
+    assert(list            != NULL);
+    assert(list->hashTable != NULL);
+
+    list_elem_t value = list->nodes[idx].value;
+    if (value != value) { return; }
+
+    size_t slot = listHashLookup(list, value);
+
+    list->hashChain[idx]  = list->hashTable[slot];
+    list->hashTable[slot]  = idx;
+}
+
+//-----------------------------------------------------------------------------
+//! Removes element at idx from list's hash index. Empty slots are closed by
+//! shifting back the entries probed past them, so no tombstones are left.
+//!
+//! @param [out] list   
+//! @param [in]  idx   
+//-----------------------------------------------------------------------------
+void listHashRemove(List* list, size_t idx)
+{
+    assert(list            != NULL);
+    assert(list->hashTable != NULL);
+
+    list_elem_t value = list->nodes[idx].value;
+    if (value != value) { return; }
+
+    size_t slot = listHashLookup(list, value);
+    assert(list->hashTable[slot] != 0);
+
+    if ((size_t) list->hashTable[slot] != idx)
+    {
+        int prev = list->hashTable[slot];
+        while ((size_t) list->hashChain[prev] != idx)
+        {
+            prev = list->hashChain[prev];
+        }
+
+        list->hashChain[prev] = list->hashChain[idx];
+        return;
+    }
+
+    if (list->hashChain[idx] != 0)
+    {
+        list->hashTable[slot] = list->hashChain[idx];
+        return;
+    }
+
+    size_t mask = list->hashTableSize - 1;
+    size_t hole = slot;
+    for (size_t next = (hole + 1) & mask; list->hashTable[next] != 0; next = (next + 1) & mask)
+    {
+        size_t home = listHashValue(list->nodes[list->hashTable[next]].value) & mask;
+
+        if (((next - home) & mask) >= ((next - hole) & mask))
+        {
+            list->hashTable[hole] = list->hashTable[next];
+            hole = next;
+        }
+    }
+
+    list->hashTable[hole] = 0;
+}
+
+//-----------------------------------------------------------------------------
+//! Reallocates list's hash table to fit list's capacity and fills it again.
+//!
+//! @param [out] list   
+//!
+//! @note if calloc returned NULL then sets list's errorStatus to 
+//!       LIST_REALLOCATION_FAILED.
+//!
+//! @return whether or not the hash table has been rebuilt.
+//-----------------------------------------------------------------------------
+bool listHashRebuild(List* list)
+{
+    assert(list            != NULL);
+    assert(list->hashChain != NULL);
+
+    size_t tableSize = 1;
+    while (tableSize < 2 * list->capacity) { tableSize *= 2; }
+
+    int* table = (int*) calloc(tableSize, sizeof(int));
+
+    if (table == NULL)
+    {
+        setError(list, LIST_REALLOCATION_FAILED);
+        return false;
+    }
+
+    free(list->hashTable);
+
+    list->hashTable     = table;
+    list->hashTableSize = tableSize;
+
+    for (size_t index = list->head; index != 0; index = list->nodes[index].next)
+    {
+        listHashInsert(list, index);
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//! Starts maintaining a hash index from values to elements, which makes 
+//! find work in O(1) on average. The index is an open addressing table of 
+//! ints (at most half full) plus one int per node chaining equal values.
+//!
+//! @param [out] list   
+//!
+//! @note if calloc returned NULL then sets list's errorStatus to 
+//!       LIST_REALLOCATION_FAILED.
+//!
+//! @return whether or not hash index is enabled.
+//-----------------------------------------------------------------------------
+bool enableHashIndex(List* list)
+{
+    ASSERT_LIST_OK(list);
+    assert(list->shared == NULL);
+
+    if (list->hashTable != NULL) { return true; }
+
+    list->hashChain = (int*) calloc(list->capacity, sizeof(int));
+
+    if (list->hashChain == NULL)
+    {
+        setError(list, LIST_REALLOCATION_FAILED);
+        return false;
+    }
+
+    if (!listHashRebuild(list))
+    {
+        free(list->hashChain);
+        list->hashChain = NULL;
+
+        return false;
+    }
+
+    ASSERT_LIST_OK(list);
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//! Stops maintaining list's hash index and frees it.
+//!
+//! @param [out] list   
+//-----------------------------------------------------------------------------
+void disableHashIndex(List* list)
+{
+    ASSERT_LIST_OK(list);
+
+    free(list->hashTable);
+    free(list->hashChain);
+
+    list->hashTable     = NULL;
+    list->hashChain     = NULL;
+    list->hashTableSize = 0;
+}
+
+//-----------------------------------------------------------------------------
+//! Starts maintaining a rank index of list's order, which makes positional
+//! access (atPos, insertAtPos, removeAtPos, LIST_SLOW::findIndex and 
+//! LIST_SLOW::findPos) work in O(log(n)) on average without linearizing the
+//! list. The index is a treap with the elements in list's order, its node
+//! for element at idx is kept at the same idx.
+//!
+//! @param [out] list   
+//!
+//! @note Does nothing if the rank index is already enabled.
+//! @note if calloc returned NULL then sets list's errorStatus to 
+//!       LIST_REALLOCATION_FAILED.
+//!
+//! @return whether or not rank index is enabled.
+//-----------------------------------------------------------------------------
+bool enableRankIndex(List* list)
+{
+    ASSERT_LIST_OK(list);
+    assert(list->shared == NULL);
+
+    if (list->rankNodes != NULL) { return true; }
+
+    list->rankNodes = (ListRankNode*) calloc(list->capacity, sizeof(ListRankNode));
+
+    if (list->rankNodes == NULL)
+    {
+        setError(list, LIST_REALLOCATION_FAILED);
+        return false;
+    }
+
+    if (list->rankSeed == 0) { list->rankSeed = 0x9E3779B9; }
+
+    listRankRebuild(list);
+
+    ASSERT_LIST_OK(list);
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//! Stops maintaining list's rank index and frees it.
+//!
+//! @param [out] list   
+//-----------------------------------------------------------------------------
+void disableRankIndex(List* list)
+{
+    ASSERT_LIST_OK(list);
+
+    free(list->rankNodes);
+
+    list->rankNodes = NULL;
+    list->rankRoot  = 0;
+}
+
+//-----------------------------------------------------------------------------
+//! Inserts value so that it gets position pos in list. 
+//!
+//! @param [out] list   
+//! @param [in]  value   
+//! @param [in]  pos   from 1 to list's size + 1
+//!
+//! @note Takes O(1) if list is linearized, O(log(n)) with the rank index 
+//!       enabled and O(n) otherwise.
+//! @note Can call resize function if there are no free space left.
+//!
+//! @return index at which value was inserted.
+//-----------------------------------------------------------------------------
+int insertAtPos(List* list, list_elem_t value, size_t pos)
+{
+    ASSERT_LIST_OK(list);
+    assert(pos >= 1 && pos <= list->size + 1);
+
+    return insertAfter(list, value, pos > 1 ? LIST_SLOW::findIndex(list, pos - 1) : 0);
+}
+
+//-----------------------------------------------------------------------------
+//! Removes element at position pos in list.
+//!
+//! @param [out] list   
+//! @param [in]  pos   from 1 to list's size
+//!
+//! @note Takes O(1) if list is linearized, O(log(n)) with the rank index 
+//!       enabled and O(n) otherwise.
+//!
+//! @return element removed.
+//-----------------------------------------------------------------------------
+list_elem_t removeAtPos(List* list, size_t pos)
+{
+    ASSERT_LIST_OK(list);
+    assert(pos >= 1 && pos <= list->size);
+
+    return remove(list, LIST_SLOW::findIndex(list, pos));
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] list   
+//! @param [in] pos   from 1 to list's size
+//!
+//! @note Takes O(1) if list is linearized, O(log(n)) with the rank index 
+//!       enabled and O(n) otherwise.
+//!
+//! @return element at position pos in list.
+//-----------------------------------------------------------------------------
+list_elem_t atPos(List* list, size_t pos)
+{
+    ASSERT_LIST_OK(list);
+    assert(pos >= 1 && pos <= list->size);
+
+    return list->nodes[LIST_SLOW::findIndex(list, pos)].value;
+}
+
+//-----------------------------------------------------------------------------
+//! @param [out] list   
+//!
+//! @return next pseudo-random treap priority of list's rank index.
+//-----------------------------------------------------------------------------
+uint32_t listRankPriority(List* list)
+{
+    assert(list != NULL);
+
+    uint32_t seed = list->rankSeed;
+
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+
+    list->rankSeed = seed;
+
+    return seed;
+}
+
+//-----------------------------------------------------------------------------
+//! Rotates node idx of list's rank index above its parent, keeping the 
+//! order of the nodes and their subtree sizes.
+//!
+//! @param [out] list   
+//! @param [in]  idx   node that has a parent
+//-----------------------------------------------------------------------------
+void listRankRotateUp(List* list, size_t idx)
+{
+    assert(list            != NULL);
+    assert(list->rankNodes != NULL);
+
+    ListRankNode* rank   = list->rankNodes;
+    size_t        parent = rank[idx].parent;
+    size_t        grand  = rank[parent].parent;
+    size_t        moved  = 0;
+
+    assert(parent != 0);
+
+    if (rank[parent].left == (int) idx)
+    {
+        moved             = rank[idx].right;
+        rank[parent].left = moved;
+        rank[idx].right   = parent;
+    }
+    else
+    {
+        moved              = rank[idx].left;
+        rank[parent].right = moved;
+        rank[idx].left     = parent;
+    }
+
+    if (moved != 0) { rank[moved].parent = parent; }
+
+    rank[parent].parent = idx;
+    rank[idx].parent    = grand;
+
+    if      (grand == 0)                      { list->rankRoot    = idx; }
+    else if (rank[grand].left == (int) parent) { rank[grand].left  = idx; }
+    else                                      { rank[grand].right = idx; }
+
+    rank[parent].size = rank[rank[parent].left].size + rank[rank[parent].right].size + 1;
+    rank[idx].size    = rank[rank[idx].left].size    + rank[rank[idx].right].size    + 1;
+}
+
+//-----------------------------------------------------------------------------
+//! Adds element at idx, which has just been linked after element at after, 
+//! to list's rank index.
+//!
+//! @param [out] list   
+//! @param [in]  idx   
+//! @param [in]  after   0 if element at idx is list's head
+//-----------------------------------------------------------------------------
+void listRankInsert(List* list, size_t idx, size_t after)
+{
+    assert(list            != NULL);
+    assert(list->rankNodes != NULL);
+
+    ListRankNode* rank = list->rankNodes;
+
+    rank[idx]          = {};
+    rank[idx].size     = 1;
+    rank[idx].priority = listRankPriority(list);
+
+    if (list->rankRoot == 0)
+    {
+        list->rankRoot = idx;
+        return;
+    }
+
+    // the new node becomes a leaf right after after in the treap's order
+    size_t parent = after;
+    bool   isLeft = false;
+
+    if (after == 0 || rank[after].right != 0)
+    {
+        parent = after == 0 ? list->rankRoot : rank[after].right;
+        while (rank[parent].left != 0) { parent = rank[parent].left; }
+
+        isLeft = true;
+    }
+
+    if (isLeft) { rank[parent].left  = idx; }
+    else        { rank[parent].right = idx; }
+
+    rank[idx].parent = parent;
+
+    for (size_t node = parent; node != 0; node = rank[node].parent)
+    {
+        rank[node].size++;
+    }
+
+    while (rank[idx].parent != 0 && rank[rank[idx].parent].priority < rank[idx].priority)
+    {
+        listRankRotateUp(list, idx);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//! Removes element at idx from list's rank index.
+//!
+//! @param [out] list   
+//! @param [in]  idx   
+//-----------------------------------------------------------------------------
+void listRankRemove(List* list, size_t idx)
+{
+    assert(list            != NULL);
+    assert(list->rankNodes != NULL);
+
+    ListRankNode* rank = list->rankNodes;
+
+    // the node is rotated down until it has at most one child to replace it
+    while (rank[idx].left != 0 && rank[idx].right != 0)
+    {
+        size_t left  = rank[idx].left;
+        size_t right = rank[idx].right;
+
+        listRankRotateUp(list, rank[left].priority > rank[right].priority ? left : right);
+    }
+
+    size_t child  = rank[idx].left != 0 ? rank[idx].left : rank[idx].right;
+    size_t parent = rank[idx].parent;
+
+    if (child != 0) { rank[child].parent = parent; }
+
+    if      (parent == 0)                    { list->rankRoot     = child; }
+    else if (rank[parent].left == (int) idx) { rank[parent].left  = child; }
+    else                                     { rank[parent].right = child; }
+
+    for (size_t node = parent; node != 0; node = rank[node].parent)
+    {
+        rank[node].size--;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//! Builds list's rank index from scratch in O(n). Elements come in list's
+//! order, so each one is attached to the right spine of the treap built so
+//! far, and a node's subtree is complete once the node leaves the spine.
+//!
+//! @param [out] list   
+//-----------------------------------------------------------------------------
+void listRankRebuild(List* list)
+{
+    assert(list            != NULL);
+    assert(list->rankNodes != NULL);
+
+    ListRankNode* rank = list->rankNodes;
+
+    list->rankRoot = 0;
+
+    size_t last = 0;
+    for (size_t index = list->head; index != 0; index = list->nodes[index].next)
+    {
+        rank[index]          = {};
+        rank[index].priority = listRankPriority(list);
+
+        size_t node   = last;
+        size_t popped = 0;
+
+        while (node != 0 && rank[node].priority < rank[index].priority)
+        {
+            rank[node].size = rank[rank[node].left].size + rank[rank[node].right].size + 1;
+
+            popped = node;
+            node   = rank[node].parent;
+        }
+
+        rank[index].left   = popped;
+        rank[index].parent = node;
+
+        if (popped != 0) { rank[popped].parent = index; }
+
+        if (node != 0) { rank[node].right = index; }
+        else           { list->rankRoot   = index; }
+
+        last = index;
+    }
+
+    for (size_t node = last; node != 0; node = rank[node].parent)
+    {
+        rank[node].size = rank[rank[node].left].size + rank[rank[node].right].size + 1;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] list   
+//! @param [in] idx   index of an element in list
+//!
+//! @return position of the element at idx found by list's rank index.
+//-----------------------------------------------------------------------------
+size_t listRankPosOf(List* list, size_t idx)
+{
+    assert(list            != NULL);
+    assert(list->rankNodes != NULL);
+
+    ListRankNode* rank = list->rankNodes;
+
+    size_t pos = rank[rank[idx].left].size + 1;
+
+    for (size_t node = idx, parent = rank[idx].parent; parent != 0; node = parent, parent = rank[parent].parent)
+    {
+        if (rank[parent].right == (int) node) { pos += rank[rank[parent].left].size + 1; }
+    }
+
+    return pos;
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] list   
+//! @param [in] pos   from 1 to list's size
+//!
+//! @return index of the element at pos found by list's rank index.
+//-----------------------------------------------------------------------------
+size_t listRankIndexAt(List* list, size_t pos)
+{
+    assert(list            != NULL);
+    assert(list->rankNodes != NULL);
+
+    ListRankNode* rank = list->rankNodes;
+
+    size_t node = list->rankRoot;
+    while (true)
+    {
+        size_t leftSize = rank[rank[node].left].size;
+
+        if (pos == leftSize + 1) { return node; }
+
+        if (pos <= leftSize)
+        {
+            node = rank[node].left;
+        }
+        else
+        {
+            pos -= leftSize + 1;
+            node  = rank[node].right;
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] list   
+//!
+//! @return whether or not list's rank index (if enabled) holds list's 
+//!         elements in list's order with correct subtree sizes and links.
+//-----------------------------------------------------------------------------
+bool listRankOk(List* list)
+{
+    assert(list != NULL);
+
+    if (list->rankNodes == NULL) { return true; }
+
+    ListRankNode* rank = list->rankNodes;
+
+    if (rank[0].size != 0 || rank[list->rankRoot].size != list->size) { return false; }
+    if (list->rankRoot != 0 && rank[list->rankRoot].parent != 0)       { return false; }
+
+    size_t pos = 1;
+    for (size_t index = list->head; index != 0; index = list->nodes[index].next, pos++)
+    {
+        size_t left   = rank[index].left;
+        size_t right  = rank[index].right;
+        size_t parent = rank[index].parent;
+
+        if (rank[index].size != rank[left].size + rank[right].size + 1)             { return false; }
+        if ((left  != 0 && rank[left].parent  != (int) index) ||
+            (right != 0 && rank[right].parent != (int) index))                      { return false; }
+        if (parent != 0 && rank[parent].priority < rank[index].priority)            { return false; }
+        if (listRankPosOf(list, index) != pos)                                      { return false; }
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//! Starts tracking a generation per slot, so that handles to removed elements
+//! are recognized as stale. Every slot starts at generation 0.
+//!
+//! @param [out] list   
+//!
+//! @note Does nothing if generations are already enabled.
+//! @note if calloc returned NULL then sets list's errorStatus to 
+//!       LIST_REALLOCATION_FAILED.
+//!
+//! @return whether or not generations are enabled.
+//-----------------------------------------------------------------------------
+bool enableGenerations(List* list)
+{
+    ASSERT_LIST_OK(list);
+    assert(list->shared == NULL);
+
+    if (list->generations != NULL) { return true; }
+
+    list->generations = (uint32_t*) calloc(list->capacity, sizeof(uint32_t));
+
+    if (list->generations == NULL)
+    {
+        setError(list, LIST_REALLOCATION_FAILED);
+        return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//! Sets the callback fired for every element whose index is changed by a 
+//! rewrite of list's buffer (see LIST_SLOW::switchToIndexSearch).
+//!
+//! @param [out] list   
+//! @param [in]  callback   NULL to disable
+//! @param [in]  context    passed to callback as is
+//!
+//! @warning callback must not modify list.
+//-----------------------------------------------------------------------------
+void setRemapCallback(List* list, ListRemapCallback callback, void* context)
+{
+    ASSERT_LIST_OK(list);
+
+    list->remapCallback = callback;
+    list->remapContext  = context;
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] list   
+//! @param [in] idx   index of an element in list or 0
+//!
+//! @note If generations aren't enabled, handle's generation is always 0 and 
+//!       handle only detects that its slot is free.
+//!
+//! @return handle to the element at idx.
+//-----------------------------------------------------------------------------
+ListHandle getHandle(List* list, size_t idx)
+{
+    ASSERT_LIST_OK(list);
+    assert(idx < list->capacity);
+    assert(!listIsFree(list, idx));
+
+    ListHandle handle = {};
+    handle.index      = idx;
+    handle.generation = list->generations != NULL ? list->generations[idx] : 0;
+
+    return handle;
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] list   
+//! @param [in] handle   
+//!
+//! @return whether or not handle still refers to an element of list. Works 
+//!         in O(1).
+//-----------------------------------------------------------------------------
+bool isHandleValid(List* list, ListHandle handle)
+{
+    ASSERT_LIST_OK(list);
+
+    if (handle.index == 0 || handle.index >= list->capacity) { return false; }
+    if (listIsFree(list, handle.index))                      { return false; }
+
+    return list->generations == NULL || list->generations[handle.index] == handle.generation;
+}
+
+//-----------------------------------------------------------------------------
+//! Reads element referred to by handle.
+//!
+//! @param [in]  list   
+//! @param [in]  handle   
+//! @param [out] value   set to the element if handle is valid
+//!
+//! @return whether or not handle is valid.
+//-----------------------------------------------------------------------------
+bool atHandle(List* list, ListHandle handle, list_elem_t* value)
+{
+    assert(value != NULL);
+
+    if (!isHandleValid(list, handle)) { return false; }
+
+    *value = list->nodes[handle.index].value;
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//! Removes element referred to by handle from list.
+//!
+//! @param [out] list   
+//! @param [in]  handle   
+//! @param [out] value   set to the removed element if handle is valid, can 
+//!              be NULL
+//!
+//! @return whether or not handle was valid.
+//-----------------------------------------------------------------------------
+bool removeHandle(List* list, ListHandle handle, list_elem_t* value)
+{
+    if (!isHandleValid(list, handle)) { return false; }
+
+    list_elem_t removed = remove(list, handle.index);
+    if (value != NULL) { *value = removed; }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//! Inserts value to list after element referred to by handle.
+//!
+//! @param [out] list   
+//! @param [in]  value   
+//! @param [in]  handle   handle with index 0 inserts value at the front
+//!
+//! @note Can call resize function if there are no free space left.
+//!
+//! @return handle to the inserted element or handle with index 0 if handle
+//!         is stale or insertion failed.
+//-----------------------------------------------------------------------------
+ListHandle insertAfterHandle(List* list, list_elem_t value, ListHandle handle)
+{
+    if (handle.index != 0 && !isHandleValid(list, handle)) { return ListHandle(); }
+
+    int inserted = insertAfter(list, value, handle.index);
+    if (inserted == 0) { return ListHandle(); }
+
+    return getHandle(list, inserted);
+}
+
+//-----------------------------------------------------------------------------
+//! Gives every element of list count - 1 more independent orders. Chain 0 is
+//! list's usual order, extra chains keep their links in a parallel array, 
+//! with slot 0 as the sentinel (its next is the chain's head and its prev is
+//! the chain's tail). Existing elements enter extra chains in list's order.
+//!
+//! @param [out] list   
+//! @param [in]  count   total number of chains
+//!
+//! @note insertAfter puts new elements at the tail of extra chains and 
+//!       remove unlinks the element from all of them.
+//! @note if calloc returned NULL then sets list's errorStatus to 
+//!       LIST_REALLOCATION_FAILED.
+//!
+//! @return whether or not the chains have been enabled.
+//-----------------------------------------------------------------------------
+bool enableChains(List* list, size_t count)
+{
+    ASSERT_LIST_OK(list);
+    assert(list->batch      == NULL);
+    assert(list->chainLinks == NULL);
+    assert(list->shared     == NULL);
+    assert(count > 1);
+
+    list->chainLinks = (ListLink*) calloc(list->capacity * (count - 1), sizeof(ListLink));
+
+    if (list->chainLinks == NULL)
+    {
+        setError(list, LIST_REALLOCATION_FAILED);
+        return false;
+    }
+
+    list->chainsCount = count;
+
+    for (size_t index = list->head; index != 0; index = list->nodes[index].next)
+    {
+        for (size_t chain = 1; chain < count; chain++)
+        {
+            listChainLinkAfter(list, index, listChainLink(list, 0, chain)->prev, chain);
+        }
+    }
+
+    ASSERT_LIST_OK(list);
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//! Inserts value after idx in chain and at the tail of every other chain.
+//!
+//! @param [out] list   
+//! @param [in]  value   
+//! @param [in]  idx   0 inserts value at chain's head
+//! @param [in]  chain   
+//!
+//! @note Can call resize function if there are no free space left.
+//!
+//! @return index at which value was inserted.
+//-----------------------------------------------------------------------------
+int insertAfterChain(List* list, list_elem_t value, size_t idx, size_t chain)
+{
+    ASSERT_LIST_OK(list);
+    assert(chain < list->chainsCount);
+
+    if (chain == 0) { return insertAfter(list, value, idx); }
+
+    int inserted = insertAfter(list, value, list->tail);
+    if (inserted == 0) { return 0; }
+
+    moveAfterChain(list, inserted, idx, chain);
+
+    return inserted;
+}
+
+//-----------------------------------------------------------------------------
+//! Moves element at idx right after element at after in list's order. The 
+//! element keeps its slot, so its index and handles stay valid.
+//!
+//! @param [out] list   
+//! @param [in]  idx   
+//! @param [in]  after   0 moves element to the front
+//-----------------------------------------------------------------------------
+void moveAfter(List* list, size_t idx, size_t after)
+{
+    ASSERT_LIST_OK(list);
+    assert(list->batch == NULL);
+    assert(idx > 0 && idx < list->capacity && after < list->capacity);
+    assert(!listIsFree(list, idx) && !listIsFree(list, after));
+
+    LIST_PROFILE(list, LIST_PROFILE_MOVE);
+
+    if (idx == after || list->nodes[idx].prev == (int) after) { return; }
+
+    size_t prev = list->nodes[idx].prev;
+    size_t next = list->nodes[idx].next;
+
+    if (list->rankNodes != NULL) { listRankRemove(list, idx); }
+
+    if (prev != 0) { list->nodes[prev].next = next; }
+    else           { listSetHead(list, next);       }
+
+    if (next != 0) { list->nodes[next].prev = prev; }
+    else           { list->tail             = prev; }
+
+    size_t afterNext = after != 0 ? list->nodes[after].next : list->head;
+
+    list->nodes[idx].prev = after;
+    list->nodes[idx].next = afterNext;
+
+    if (after     != 0) { list->nodes[after].next     = idx; }
+    else                { listSetHead(list, idx);              }
+
+    if (afterNext != 0) { list->nodes[afterNext].prev = idx; }
+    else                { list->tail                  = idx; }
+
+    if (list->rankNodes != NULL) { listRankInsert(list, idx, after); }
+
+    if (list->snapshotChunks != NULL)
+    {
+        listSnapshotTouch(list, idx);
+        listSnapshotTouch(list, prev);
+        listSnapshotTouch(list, next);
+        listSnapshotTouch(list, after);
+        listSnapshotTouch(list, afterNext);
+    }
+
+    list->searchEnabled = true;
+
+    ASSERT_LIST_OK(list);
+}
+
+//-----------------------------------------------------------------------------
+//! Moves element at idx right after element at after in chain only.
+//!
+//! @param [out] list   
+//! @param [in]  idx   
+//! @param [in]  after   0 moves element to chain's head
+//! @param [in]  chain   
+//-----------------------------------------------------------------------------
+void moveAfterChain(List* list, size_t idx, size_t after, size_t chain)
+{
+    ASSERT_LIST_OK(list);
+    assert(chain < list->chainsCount);
+
+    if (chain == 0) { moveAfter(list, idx, after); return; }
+
+    assert(idx > 0 && idx < list->capacity && after < list->capacity);
+    assert(!listIsFree(list, idx) && !listIsFree(list, after));
+
+    if (idx == after || listChainLink(list, idx, chain)->prev == (int) after) { return; }
+
+    listChainUnlink   (list, idx, chain);
+    listChainLinkAfter(list, idx, after, chain);
+
+    ASSERT_LIST_OK(list);
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] list   
+//! @param [in] idx   index of an element or 0
+//! @param [in] chain   
+//!
+//! @return index of the element following idx in chain (chain's head if idx
+//!         is 0) or 0 if there's none.
+//-----------------------------------------------------------------------------
+int chainNext(List* list, size_t idx, size_t chain)
+{
+    ASSERT_LIST_OK(list);
+    assert(chain < list->chainsCount);
+    assert(idx < list->capacity);
+
+    if (chain == 0) { return idx == 0 ? list->head : list->nodes[idx].next; }
+
+    return listChainLink(list, idx, chain)->next;
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] list   
+//! @param [in] idx   index of an element or 0
+//! @param [in] chain   
+//!
+//! @return index of the element preceding idx in chain (chain's tail if idx
+//!         is 0) or 0 if there's none.
+//-----------------------------------------------------------------------------
+int chainPrev(List* list, size_t idx, size_t chain)
+{
+    ASSERT_LIST_OK(list);
+    assert(chain < list->chainsCount);
+    assert(idx < list->capacity);
+
+    if (chain == 0) { return idx == 0 ? list->tail : list->nodes[idx].prev; }
+
+    return listChainLink(list, idx, chain)->prev;
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] list   
+//! @param [in] idx   
+//! @param [in] chain   extra chain, not 0
+//!
+//! @return links of slot idx in chain.
+//-----------------------------------------------------------------------------
+ListLink* listChainLink(List* list, size_t idx, size_t chain)
+{
+    assert(list             != NULL);
+    assert(list->chainLinks != NULL);
+    assert(chain > 0 && chain < list->chainsCount);
+
+    return &list->chainLinks[idx * (list->chainsCount - 1) + chain - 1];
+}
+
+//-----------------------------------------------------------------------------
+//! Links element at idx into chain right after element at after.
+//!
+//! @param [out] list   
+//! @param [in]  idx   
+//! @param [in]  after   
+//! @param [in]  chain   extra chain, not 0
+//-----------------------------------------------------------------------------
+void listChainLinkAfter(List* list, size_t idx, size_t after, size_t chain)
+{
+    assert(list != NULL);
+
+    ListLink* link      = listChainLink(list, idx,   chain);
+    ListLink* afterLink = listChainLink(list, after, chain);
+
+    link->prev = after;
+    link->next = afterLink->next;
+
+    listChainLink(list, afterLink->next, chain)->prev = idx;
+    afterLink->next = idx;
+}
+
+//-----------------------------------------------------------------------------
+//! Unlinks element at idx from chain.
+//!
+//! @param [out] list   
+//! @param [in]  idx   
+//! @param [in]  chain   extra chain, not 0
+//-----------------------------------------------------------------------------
+void listChainUnlink(List* list, size_t idx, size_t chain)
+{
+    assert(list != NULL);
+
+    ListLink* link = listChainLink(list, idx, chain);
+
+    listChainLink(list, link->prev, chain)->next = link->next;
+    listChainLink(list, link->next, chain)->prev = link->prev;
+}
+
+//-----------------------------------------------------------------------------
+//! Rewrites extra chains' links after list's buffer has been linearized.
+//!
+//! @param [out] list   
+//! @param [in]  oldNodes   buffer before linearization
+//! @param [in]  oldHead   head before linearization
+//! @param [in]  oldCapacity   capacity before linearization, which is also 
+//!              the capacity list's chain links have been allocated for
+//-----------------------------------------------------------------------------
+void listLinearizeChains(List* list, ListNode* oldNodes, size_t oldHead, size_t oldCapacity)
+{
+    assert(list     != NULL);
+    assert(oldNodes != NULL);
+
+    size_t extraChains = list->chainsCount - 1;
+
+    int*      newIndex = (int*)      calloc(oldCapacity, sizeof(int));
+    ListLink* newLinks = (ListLink*) calloc(list->capacity * extraChains, sizeof(ListLink));
+    assert(newIndex != NULL && newLinks != NULL);
+
+    size_t oldIndex = oldHead;
+    for (size_t i = 1; i <= list->size; i++)
+    {
+        newIndex[oldIndex] = i;
+        oldIndex = oldNodes[oldIndex].next;
+    }
+
+    oldIndex = 0;
+    for (size_t i = 0; i <= list->size; i++)
+    {
+        for (size_t chain = 1; chain <= extraChains; chain++)
+        {
+            ListLink* oldLink = listChainLink(list, oldIndex, chain);
+            ListLink* newLink = &newLinks[i * extraChains + chain - 1];
+
+            newLink->prev = newIndex[oldLink->prev];
+            newLink->next = newIndex[oldLink->next];
+        }
+
+        oldIndex = i == 0 ? oldHead : oldNodes[oldIndex].next;
+    }
+
+    free(list->chainLinks);
+    free(newIndex);
+
+    list->chainLinks = newLinks;
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] list   
+//!
+//! @return whether or not every extra chain of list has all of list's 
+//!         elements, without loops and with consistent links.
+//-----------------------------------------------------------------------------
+bool listChainsOk(List* list)
+{
+    assert(list != NULL);
+
+    for (size_t chain = 1; chain < list->chainsCount; chain++)
+    {
+        size_t prev  = 0;
+        size_t index = listChainLink(list, 0, chain)->next;
+        size_t count = 0;
+
+        for (; index != 0; count++)
+        {
+            if (count >= list->size || index >= list->capacity || listIsFree(list, index)) { return false; }
+            if (listChainLink(list, index, chain)->prev != (int) prev)                       { return false; }
+
+            prev  = index;
+            index = listChainLink(list, index, chain)->next;
+        }
+
+        if (count != list->size)                               { return false; }
+        if (listChainLink(list, 0, chain)->prev != (int) prev) { return false; }
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//! Copies element from oldIndex of list's buffer to newIndex of newNodes.
+//!
+//! @param [in]  list   
+//! @param [out] newNodes   
+//! @param [out] newGenerations   NULL if generations aren't enabled
+//! @param [in]  oldIndex   
+//! @param [in]  newIndex   
+//-----------------------------------------------------------------------------
+void listLinearizeNode(List* list, ListNode* newNodes, uint32_t* newGenerations, size_t oldIndex, size_t newIndex)
+{
+    newNodes[newIndex] = list->nodes[oldIndex];
+
+    newNodes[newIndex].next = newIndex < list->size ? newIndex + 1 : 0;
+    newNodes[newIndex].prev = newIndex > 1          ? newIndex - 1 : 0;
+
+    if (newGenerations != NULL && oldIndex == newIndex)
+    {
+        newGenerations[newIndex] = list->generations[newIndex];
+    }
+}
+
+//-----------------------------------------------------------------------------
+//! Rewrites list's buffer so that elements are placed in order of the next 
+//! links starting from list's head. 
+//!
+//! @param [out] list   
+//! @param [in]  prevValid   whether or not prev links are valid, otherwise 
+//!              they are ignored
+//!
+//! @note If two-ended traversal is enabled (see setTwoEndedSearch) and prev 
+//!       links are valid, the list is walked from both ends at once.
+//-----------------------------------------------------------------------------
+void listLinearize(List* list, bool prevValid)
+{
+    assert(list != NULL);
+
+    void*     newBlock = NULL;
+    ListNode* newNodes = listAllocNodes(list->capacity, &newBlock);
+    assert(newNodes != NULL);
+
+    // Element that stays in its slot keeps its generation, every other slot 
+    // gets a new one, so that handles to the old layout become stale.
+    uint32_t* newGenerations = NULL;
+    if (list->generations != NULL)
+    {
+        newGenerations = (uint32_t*) calloc(list->capacity, sizeof(uint32_t));
+        assert(newGenerations != NULL);
+
+        for (size_t i = 0; i < list->capacity; i++)
+        {
+            newGenerations[i] = list->generations[i] + 1;
+        }
+    }
+
+    newNodes[0] = list->nodes[0];
+
+    size_t oldIndex = list->head;
+
+    if (prevValid && list->twoEndedSearch)
+    {
+        size_t oldBackIndex = list->tail;
+
+        for (size_t i = 1, j = list->size; i <= j; i++, j--)
+        {
+            size_t nextIndex     = list->nodes[oldIndex].next;
+            size_t nextBackIndex = list->nodes[oldBackIndex].prev;
+
+            listLinearizeNode(list, newNodes, newGenerations, oldIndex, i);
+
+            if (i != j)
+            {
+                listLinearizeNode(list, newNodes, newGenerations, oldBackIndex, j);
+            }
+
+            oldIndex     = nextIndex;
+            oldBackIndex = nextBackIndex;
+        }
+    }
+    else
+    {
+        for (size_t i = 1; i <= list->size; i++)
+        {
+            size_t nextIndex = list->nodes[oldIndex].next;
+
+            listLinearizeNode(list, newNodes, newGenerations, oldIndex, i);
+
+            oldIndex = nextIndex;
+        }
+    }
+
+    ListNode* oldNodes       = list->nodes;
+    void*     oldBlock       = list->nodesBlock;
+    uint32_t* oldGenerations = list->generations;
+    size_t    oldHead        = list->head;
+
+    list->nodes       = newNodes;
+    list->nodesBlock  = newBlock;
+    list->generations = newGenerations;
+
+    listSetHead(list, list->size > 0 ? 1 : 0);
+    list->tail = list->size;
+
+    memset(list->freeMap, 0, listFreeMapWords(list->capacity) * sizeof(uint64_t));
+    listUpdateFree(list, list->size + 1);
+
+    if (list->snapshotChunks != NULL) { listSnapshotTouchAll(list); }
+
+    LIST_SET_CANARIES(list);    
+
+    if (list->hashTable != NULL)
+    {
+        memset(list->hashTable, 0, list->hashTableSize * sizeof(int));
+
+        for (size_t i = 1; i <= list->size; i++)
+        {
+            listHashInsert(list, i);
+        }
+    }
+
+    if (list->chainLinks != NULL) { listLinearizeChains(list, oldNodes, oldHead, list->capacity); }
+    if (list->rankNodes  != NULL) { listRankRebuild(list);                        }
+
+    list->searchEnabled = false;
+
+    if (list->remapCallback != NULL)
+    {
+        oldIndex = oldHead;
+        for (size_t i = 1; i <= list->size; i++)
+        {
+            if (oldIndex != i)
+            {
+                ListHandle oldHandle = {};
+                oldHandle.index      = oldIndex;
+                oldHandle.generation = oldGenerations != NULL ? oldGenerations[oldIndex] : 0;
+
+                list->remapCallback(oldHandle, getHandle(list, i), list->remapContext);
+            }
+
+            oldIndex = oldNodes[oldIndex].next;
+        }
+    }
+
+    if (list->shared != NULL)
+    {
+        // nodes of a shared list have to stay in its shared memory object
+        memcpy(oldNodes, list->nodes, list->capacity * sizeof(ListNode));
+        free(list->nodesBlock);
+
+        list->nodes      = oldNodes;
+        list->nodesBlock = oldBlock;
+    }
+    else if (list->epochs != NULL) { listEpochRetire(list, oldBlock); }
+    else                           { free(oldBlock);                  }
+
+    free(oldGenerations);
+}
+
+//-----------------------------------------------------------------------------
+//! Cuts the chain of next links after count elements starting from first.
+//!
+//! @param [out] list   
+//! @param [in]  first   
+//! @param [in]  count   
+//!
+//! @return index following the cut part or 0 if there's none.
+//-----------------------------------------------------------------------------
+size_t listSortSplit(List* list, size_t first, size_t count)
+{
+    assert(list != NULL);
+
+    for (size_t i = 1; i < count && first != 0; i++)
+    {
+        first = list->nodes[first].next;
+    }
+
+    if (first == 0) { return 0; }
+
+    size_t rest = list->nodes[first].next;
+    list->nodes[first].next = 0;
+
+    return rest;
+}
+
+//-----------------------------------------------------------------------------
+//! Stable bottom-up merge sort of list's next links. Sets list's head and 
+//! tail, but leaves prev links stale.
+//!
+//! @param [out] list   
+//! @param [in]  less   
+//-----------------------------------------------------------------------------
+void listSortLinks(List* list, ListComparator less)
+{
+    assert(list != NULL);
+    assert(less != NULL);
+
+    for (size_t width = 1; width < list->size; width *= 2)
+    {
+        size_t current = list->head;
+        size_t newHead = 0;
+        size_t newTail = 0;
+
+        while (current != 0)
+        {
+            size_t left  = current;
+            size_t right = listSortSplit(list, left, width);
+            current      = listSortSplit(list, right, width);
+
+            while (left != 0 || right != 0)
+            {
+                size_t taken = 0;
+
+                if (right == 0 || (left != 0 && !less(list->nodes[right].value, list->nodes[left].value)))
+                {
+                    taken = left;
+                    left  = list->nodes[left].next;
+                }
+                else
+                {
+                    taken = right;
+                    right = list->nodes[right].next;
+                }
+
+                if (newTail == 0) { newHead                    = taken; }
+                else              { list->nodes[newTail].next = taken; }
+
+                newTail = taken;
+            }
+        }
+
+        list->nodes[newTail].next = 0;
+
+        listSetHead(list, newHead);
+        list->tail = newTail;
+    }
+}
+
+bool listDefaultLess(list_elem_t first, list_elem_t second)
+{
+    return first < second;
+}
+
+//-----------------------------------------------------------------------------
+//! Stable sort of list in O(n * log(n)). Only links are changed, so each 
+//! element keeps its index (and handles to it stay valid).
+//!
+//! @param [out] list   
+//! @param [in]  less   returns whether or not first argument goes before the 
+//!              second one, NULL to sort in ascending order
+//-----------------------------------------------------------------------------
+void sortList(List* list, ListComparator less)
+{
+    ASSERT_LIST_OK(list);
+    assert(list->batch == NULL);
+
+    LIST_PROFILE(list, LIST_PROFILE_SORT);
+
+    if (list->size < 2) { return; }
+
+    listSortLinks(list, less != NULL ? less : listDefaultLess);
+
+    size_t prev = 0;
+    for (size_t index = list->head; index != 0; index = list->nodes[index].next)
+    {
+        list->nodes[index].prev = prev;
+        prev = index;
+    }
+
+    if (list->snapshotChunks != NULL) { listSnapshotTouchAll(list); }
+    if (list->rankNodes      != NULL) { listRankRebuild(list);      }
+
+    list->searchEnabled = true;
+
+    ASSERT_LIST_OK(list);
+}
+
+//-----------------------------------------------------------------------------
+//! Makes sure the undo log of list's batch has space for one more entry. Has
+//! to be called before the operation changes anything, so that an operation
+//! that can't be logged doesn't happen at all.
+//!
+//! @param [out] list   
+//!
+//! @note if realloc returned NULL then sets list's errorStatus to 
+//!       LIST_REALLOCATION_FAILED.
+//!
+//! @return whether or not there's space for one more entry.
+//-----------------------------------------------------------------------------
+bool listBatchGrow(List* list)
+{
+    assert(list        != NULL);
+    assert(list->batch != NULL);
+
+    ListBatch* batch = list->batch;
+
+    if (batch->size < batch->capacity) { return true; }
+
+    size_t          newCapacity = batch->capacity * 2;
+    ListBatchEntry* newLog      = (ListBatchEntry*) realloc(batch->log, newCapacity * sizeof(ListBatchEntry));
+
+    if (newLog == NULL)
+    {
+        setError(list, LIST_REALLOCATION_FAILED);
+        return false;
+    }
+
+    batch->log      = newLog;
+    batch->capacity = newCapacity;
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//! Appends the operation on element at idx to the undo log of list's batch.
+//! Removal has to be logged before the element is unlinked.
+//!
+//! @param [out] list   
+//! @param [in]  idx   
+//! @param [in]  inserted   whether element at idx was inserted or is going to
+//!              be removed
+//! @param [in]  freeHint   list's free slot hint before the operation
+//!
+//! @warning The log must have space for the entry (see listBatchGrow).
+//-----------------------------------------------------------------------------
+void listBatchLog(List* list, size_t idx, bool inserted, size_t freeHint)
+{
+    assert(list        != NULL);
+    assert(list->batch != NULL);
+
+    ListBatch* batch = list->batch;
+    assert(batch->size < batch->capacity);
+
+    ListBatchEntry* entry = &batch->log[batch->size++];
+
+    entry->value      = list->nodes[idx].value;
+    entry->index      = idx;
+    entry->prev       = list->nodes[idx].prev;
+    entry->next       = list->nodes[idx].next;
+    entry->generation = list->generations != NULL ? list->generations[idx] : 0;
+    entry->freeHint   = freeHint;
+    entry->inserted   = inserted;
+}
+
+//-----------------------------------------------------------------------------
+//! Reverts the operation logged in entry. Entries must be reverted in the 
+//! reverse order, then a removed element gets back to its slot, which is 
+//! still free, and the free slot hint is restored.
+//!
+//! @param [out] list   
+//! @param [in]  entry   
+//-----------------------------------------------------------------------------
+void listBatchUndo(List* list, ListBatchEntry* entry)
+{
+    assert(list  != NULL);
+    assert(entry != NULL);
+
+    if (entry->inserted)
+    {
+        remove(list, entry->index);
+        list->free = entry->freeHint;
+
+        return;
+    }
+
+    size_t idx = entry->index;
+    assert(listIsFree(list, idx));
+
+    listFreeMapSet(list, idx, false);
+    list->free = entry->freeHint;
+
+    list->nodes[idx].value = entry->value;
+    list->nodes[idx].prev  = entry->prev;
+    list->nodes[idx].next  = entry->next;
+
+    if (entry->prev != 0) { list->nodes[entry->prev].next = idx; }
+    else                  { listSetHead(list, idx);                }
+
+    if (entry->next != 0) { list->nodes[entry->next].prev = idx; }
+    else                  { list->tail                    = idx; }
+
+    list->size++;
+
+    if (list->snapshotChunks != NULL)
+    {
+        listSnapshotTouch(list, idx);
+        listSnapshotTouch(list, entry->prev);
+        listSnapshotTouch(list, entry->next);
+    }
+
+    if (list->generations != NULL) { list->generations[idx] = entry->generation; }
+    if (list->hashTable   != NULL) { listHashInsert(list, idx); }
+}
+
+//-----------------------------------------------------------------------------
+//! Starts a batch of insert/remove calls. The list isn't validated until the
+//! batch is committed, and every call is logged so that the whole batch can 
+//! be aborted.
+//!
+//! @param [out] list   
+//! @param [in]  maxInserts   expected number of inserts in the batch, space 
+//!              for them is allocated right away
+//!
+//! @warning Only insert/remove calls (and the ones based on them) are allowed
+//!          during a batch.
+//! @warning Batches aren't available for lists with several chains.
+//!
+//! @note if an allocation failed then sets list's errorStatus to 
+//!       LIST_REALLOCATION_FAILED.
+//!
+//! @return whether or not the batch has been started.
+//-----------------------------------------------------------------------------
+bool beginBatch(List* list, size_t maxInserts)
+{
+    ASSERT_LIST_OK(list);
+    assert(list->batch      == NULL);
+    assert(list->chainLinks == NULL);
+
+    bool searchEnabled = list->searchEnabled;
+
+    if (!reserve(list, list->size + maxInserts)) { return false; }
+
+    ListBatch* batch = (ListBatch*) calloc(1, sizeof(ListBatch));
+    if (batch == NULL)
+    {
+        setError(list, LIST_REALLOCATION_FAILED);
+        return false;
+    }
+
+    batch->capacity      = maxInserts > LIST_MINIMAL_CAPACITY ? maxInserts : LIST_MINIMAL_CAPACITY;
+    batch->log           = (ListBatchEntry*) calloc(batch->capacity, sizeof(ListBatchEntry));
+    batch->searchEnabled = searchEnabled;
+
+    if (batch->log == NULL)
+    {
+        free(batch);
+        setError(list, LIST_REALLOCATION_FAILED);
+        return false;
+    }
+
+    list->batch         = batch;
+    list->searchEnabled = true;
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//! Ends the current batch keeping all of its changes. 
+//!
+//! @param [out] list   
+//-----------------------------------------------------------------------------
+void commitBatch(List* list)
+{
+    assert(list        != NULL);
+    assert(list->batch != NULL);
+
+    free(list->batch->log);
+    free(list->batch);
+    list->batch = NULL;
+
+    ASSERT_LIST_OK(list);
+}
+
+//-----------------------------------------------------------------------------
+//! Ends the current batch reverting all of its changes. Elements removed in 
+//! the batch get back to their indices (and their handles become valid 
+//! again). Capacity allocated during the batch isn't freed.
+//!
+//! @param [out] list   
+//-----------------------------------------------------------------------------
+void abortBatch(List* list)
+{
+    assert(list        != NULL);
+    assert(list->batch != NULL);
+
+    ListBatch* batch = list->batch;
+    list->batch = NULL;
+
+    // restored elements aren't in the rank index, so it's detached while
+    // undoing and rebuilt afterwards
+    ListRankNode* rankNodes = list->rankNodes;
+    list->rankNodes = NULL;
+
+    for (size_t i = batch->size; i > 0; i--)
+    {
+        listBatchUndo(list, &batch->log[i - 1]);
+    }
+
+    list->rankNodes = rankNodes;
+    if (list->rankNodes != NULL) { listRankRebuild(list); }
+
+    list->searchEnabled = batch->searchEnabled;
+
+    free(batch->log);
+    free(batch);
+
+    ASSERT_LIST_OK(list);
+}
+
+//-----------------------------------------------------------------------------
+//! Takes a read-only view of list's current state. Snapshots are made of 
+//! immutable chunks of LIST_SNAPSHOT_CHUNK_NODES nodes. A chunk that hasn't
+//! been written to since the previous snapshot is shared with it, only the
+//! chunks touched by insert/remove calls in between are copied.
+//!
+//! @param [in] list   
+//!
+//! @warning Has to be called by the thread that modifies list. The snapshot
+//!          itself can then be read and released by any thread while list
+//!          keeps changing.
+//! @note if malloc returned NULL then sets list's errorStatus to 
+//!       LIST_REALLOCATION_FAILED.
+//!
+//! @return the snapshot or NULL if it couldn't be taken.
+//-----------------------------------------------------------------------------
+ListSnapshot* snapshotList(List* list)
+{
+    ASSERT_LIST_OK(list);
+    assert(list->shared == NULL);
+    assert(list->batch == NULL);
+
+    size_t chunksCount = listChunksCount(list->capacity);
+
+    if (list->snapshotChunks == NULL)
+    {
+        list->snapshotChunks = (ListChunk**) calloc(chunksCount, sizeof(ListChunk*));
+
+        if (list->snapshotChunks == NULL)
+        {
+            setError(list, LIST_REALLOCATION_FAILED);
+            return NULL;
+        }
+    }
+
+    ListSnapshot* snapshot = (ListSnapshot*) calloc(1, sizeof(ListSnapshot));
+    ListChunk**   chunks   = (ListChunk**)   calloc(chunksCount, sizeof(ListChunk*));
+
+    if (snapshot == NULL || chunks == NULL)
+    {
+        free(snapshot);
+        free(chunks);
+
+        setError(list, LIST_REALLOCATION_FAILED);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < chunksCount; i++)
+    {
+        ListChunk* chunk = list->snapshotChunks[i];
+
+        if (chunk == NULL)
+        {
+            chunk = (ListChunk*) malloc(sizeof(ListChunk));
+
+            if (chunk == NULL)
+            {
+                snapshot->chunks = chunks;
+                releaseSnapshot(snapshot);
+
+                setError(list, LIST_REALLOCATION_FAILED);
+                return NULL;
+            }
+
+            new (&chunk->references) std::atomic<size_t>(1);
+
+            size_t first = i * LIST_SNAPSHOT_CHUNK_NODES;
+            size_t count = list->capacity - first < LIST_SNAPSHOT_CHUNK_NODES ? 
+                           list->capacity - first : LIST_SNAPSHOT_CHUNK_NODES;
+
+            memcpy(chunk->nodes, list->nodes + first, count * sizeof(ListNode));
+
+            list->snapshotChunks[i] = chunk;
+        }
+
+        chunk->references.fetch_add(1, std::memory_order_relaxed);
+        chunks[i] = chunk;
+    }
+
+    snapshot->chunks   = chunks;
+    snapshot->size     = list->size;
+    snapshot->capacity = list->capacity;
+    snapshot->head     = list->head;
+    snapshot->tail     = list->tail;
+    snapshot->version  = ++list->snapshotVersion;
+
+    return snapshot;
+}
+
+//-----------------------------------------------------------------------------
+//! Drops a snapshot taken by snapshotList. Chunks nobody else refers to are 
+//! freed.
+//!
+//! @param [out] snapshot   
+//!
+//! @note Can be called by any thread.
+//-----------------------------------------------------------------------------
+void releaseSnapshot(ListSnapshot* snapshot)
+{
+    if (snapshot == NULL) { return; }
+
+    for (size_t i = 0; i < listChunksCount(snapshot->capacity); i++)
+    {
+        listChunkRelease(snapshot->chunks[i]);
+    }
+
+    free(snapshot->chunks);
+    free(snapshot);
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] snapshot   
+//!
+//! @return number of snapshots taken from the list before and including this
+//!         one.
+//-----------------------------------------------------------------------------
+size_t getSnapshotVersion(ListSnapshot* snapshot)
+{
+    assert(snapshot != NULL);
+
+    return snapshot->version;
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] snapshot   
+//!
+//! @return size of the list at the time snapshot was taken.
+//-----------------------------------------------------------------------------
+size_t getSnapshotSize(ListSnapshot* snapshot)
+{
+    assert(snapshot != NULL);
+
+    return snapshot->size;
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] snapshot   
+//! @param [in] idx   must have been an index of an element at the time 
+//!             snapshot was taken
+//!
+//! @return element at idx at the time snapshot was taken.
+//-----------------------------------------------------------------------------
+list_elem_t snapshotAt(ListSnapshot* snapshot, size_t idx)
+{
+    assert(snapshot != NULL);
+    assert(idx > 0 && idx < snapshot->capacity);
+
+    return listSnapshotNode(snapshot, idx)->value;
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] snapshot   
+//! @param [in] idx   index of an element or 0
+//!
+//! @return index of the element following idx in snapshot (the first one if 
+//!         idx is 0) or 0 if there's none.
+//-----------------------------------------------------------------------------
+int snapshotNext(ListSnapshot* snapshot, size_t idx)
+{
+    assert(snapshot != NULL);
+    assert(idx < snapshot->capacity);
+
+    if (idx == 0) { return snapshot->head; }
+
+    return listSnapshotNode(snapshot, idx)->next;
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] snapshot   
+//! @param [in] idx   index of an element or 0
+//!
+//! @return index of the element preceding idx in snapshot (the last one if 
+//!         idx is 0) or 0 if there's none.
+//-----------------------------------------------------------------------------
+int snapshotPrev(ListSnapshot* snapshot, size_t idx)
+{
+    assert(snapshot != NULL);
+    assert(idx < snapshot->capacity);
+
+    if (idx == 0) { return snapshot->tail; }
+
+    return listSnapshotNode(snapshot, idx)->prev;
+}
+
+//-----------------------------------------------------------------------------
+//! Finds first occurrence of value in snapshot. 
+//!
+//! @param [in]  snapshot   
+//! @param [in]  value   
+//! @param [out] idx   index of the element found or 0 if there's none
+//! @param [out] pos   position of the element found or 0 if there's none 
+//!              (can be NULL)
+//!
+//! @return whether or not value has been found.
+//-----------------------------------------------------------------------------
+bool snapshotFind(ListSnapshot* snapshot, list_elem_t value, int* idx, int* pos)
+{
+    assert(snapshot != NULL);
+    assert(idx      != NULL);
+
+    size_t currentPos = 1;
+    for (size_t index = snapshot->head; index != 0; currentPos++)
+    {
+        ListNode* node = listSnapshotNode(snapshot, index);
+
+        if (node->value == value)
+        {
+            *idx = index;
+            if (pos != NULL) { *pos = currentPos; }
+
+            return true;
+        }
+
+        index = node->next;
+    }
+
+    *idx = 0;
+    if (pos != NULL) { *pos = 0; }
+
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] capacity   
+//!
+//! @return number of snapshot chunks covering a buffer of capacity nodes.
+//-----------------------------------------------------------------------------
+size_t listChunksCount(size_t capacity)
+{
+    return (capacity + LIST_SNAPSHOT_CHUNK_NODES - 1) / LIST_SNAPSHOT_CHUNK_NODES;
+}
+
+//-----------------------------------------------------------------------------
+//! Drops a reference to chunk and frees it if that was the last one.
+//!
+//! @param [out] chunk   can be NULL
+//-----------------------------------------------------------------------------
+void listChunkRelease(ListChunk* chunk)
+{
+    if (chunk == NULL) { return; }
+
+    if (chunk->references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        chunk->references.~atomic();
+        free(chunk);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//! Marks the chunk containing slot idx as changed since the last snapshot, 
+//! so that the next one copies it.
+//!
+//! @param [out] list   
+//! @param [in]  idx   
+//-----------------------------------------------------------------------------
+void listSnapshotTouch(List* list, size_t idx)
+{
+    assert(list                 != NULL);
+    assert(list->snapshotChunks != NULL);
+
+    if (idx == 0) { return; }
+
+    ListChunk** chunk = &list->snapshotChunks[idx / LIST_SNAPSHOT_CHUNK_NODES];
+
+    if (*chunk != NULL)
+    {
+        listChunkRelease(*chunk);
+        *chunk = NULL;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//! Marks every chunk of list as changed since the last snapshot.
+//!
+//! @param [out] list   
+//-----------------------------------------------------------------------------
+void listSnapshotTouchAll(List* list)
+{
+    assert(list                 != NULL);
+    assert(list->snapshotChunks != NULL);
+
+    for (size_t i = 0; i < listChunksCount(list->capacity); i++)
+    {
+        listChunkRelease(list->snapshotChunks[i]);
+        list->snapshotChunks[i] = NULL;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//! Resizes list's chunks table after list's buffer has been resized. If 
+//! realloc fails, the table is dropped and the next snapshot copies all the
+//! chunks.
+//!
+//! @param [out] list   
+//! @param [in]  oldCapacity   
+//-----------------------------------------------------------------------------
+void listSnapshotResize(List* list, size_t oldCapacity)
+{
+    assert(list                 != NULL);
+    assert(list->snapshotChunks != NULL);
+
+    size_t oldCount = listChunksCount(oldCapacity);
+    size_t newCount = listChunksCount(list->capacity);
+
+    if (newCount == oldCount) { return; }
+
+    ListChunk** newChunks = (ListChunk**) realloc(list->snapshotChunks, newCount * sizeof(ListChunk*));
+
+    if (newChunks == NULL)
+    {
+        for (size_t i = 0; i < oldCount; i++)
+        {
+            listChunkRelease(list->snapshotChunks[i]);
+        }
+
+        free(list->snapshotChunks);
+        list->snapshotChunks = NULL;
+
+        return;
+    }
+
+    memset(newChunks + oldCount, 0, (newCount - oldCount) * sizeof(ListChunk*));
+
+    list->snapshotChunks = newChunks;
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] snapshot   
+//! @param [in] idx   
+//!
+//! @return node at idx in snapshot.
+//-----------------------------------------------------------------------------
+ListNode* listSnapshotNode(ListSnapshot* snapshot, size_t idx)
+{
+    assert(snapshot != NULL);
+
+    return &snapshot->chunks[idx / LIST_SNAPSHOT_CHUNK_NODES]->nodes[idx % LIST_SNAPSHOT_CHUNK_NODES];
+}
+
+//-----------------------------------------------------------------------------
+//! Lets up to maxReaders threads read list while one thread modifies it. 
+//! Buffers replaced by resize and LIST_SLOW::switchToIndexSearch are retired
+//! and freed only after every read section that could have seen them ends.
+//!
+//! @param [out] list   
+//! @param [in]  maxReaders   number of read sections that can be open at once
+//!
+//! @warning Reads aren't synchronized with the writer's changes to the 
+//!          buffer: a reader is guaranteed to read allocated memory, not a 
+//!          consistent list. Use snapshotList for consistent views.
+//! @note if an allocation failed then sets list's errorStatus to 
+//!       LIST_REALLOCATION_FAILED.
+//!
+//! @return whether or not concurrent reads have been enabled.
+//-----------------------------------------------------------------------------
+bool enableConcurrentReads(List* list, size_t maxReaders)
+{
+    ASSERT_LIST_OK(list);
+    assert(list->shared == NULL);
+    assert(maxReaders > 0);
+
+    if (list->epochs != NULL) { return true; }
+
+    ListEpochs* epochs = new (std::nothrow) ListEpochs();
+    if (epochs != NULL)
+    {
+        epochs->readers = new (std::nothrow) std::atomic<uint64_t>[maxReaders]();
+    }
+
+    if (epochs == NULL || epochs->readers == NULL)
+    {
+        delete epochs;
+
+        setError(list, LIST_REALLOCATION_FAILED);
+        return false;
+    }
+
+    epochs->readersCount = maxReaders;
+    epochs->capacity.store(list->capacity);
+    epochs->nodes.store(list->nodes);
+    epochs->head.store(list->head);
+    epochs->epoch.store(1);
+
+    list->epochs = epochs;
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//! Starts a read section. Can be called by any thread.
+//!
+//! @param [in]  list   
+//! @param [out] reader   
+//!
+//! @return whether or not there was a free reader slot.
+//-----------------------------------------------------------------------------
+bool beginRead(List* list, ListReader* reader)
+{
+    assert(list         != NULL);
+    assert(list->epochs != NULL);
+    assert(reader       != NULL);
+
+    ListEpochs* epochs = list->epochs;
+
+    for (size_t i = 0; i < epochs->readersCount; i++)
+    {
+        uint64_t inactive = 0;
+
+        // the epoch announced here has to be visible before the buffer is 
+        // loaded, so that a writer retiring it after that waits for us
+        if (epochs->readers[i].compare_exchange_strong(inactive, epochs->epoch.load()))
+        {
+            reader->list     = list;
+            reader->slot     = i;
+            reader->capacity = epochs->capacity.load();
+            reader->nodes    = epochs->nodes.load();
+            reader->head     = epochs->head.load(std::memory_order_acquire);
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+//! Ends a read section. reader's nodes must not be used after that.
+//!
+//! @param [out] reader   
+//-----------------------------------------------------------------------------
+void endRead(ListReader* reader)
+{
+    assert(reader       != NULL);
+    assert(reader->list != NULL);
+
+    reader->list->epochs->readers[reader->slot].store(0, std::memory_order_release);
+
+    reader->list  = NULL;
+    reader->nodes = NULL;
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] reader   
+//! @param [in] idx   
+//!
+//! @return element at idx in the buffer reader's section has started with.
+//-----------------------------------------------------------------------------
+list_elem_t readerAt(ListReader* reader, size_t idx)
+{
+    assert(reader        != NULL);
+    assert(reader->nodes != NULL);
+    assert(idx > 0 && idx < reader->capacity);
+
+    return reader->nodes[idx].value;
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] reader   
+//! @param [in] idx   index of an element or 0
+//!
+//! @return index of the element following idx (the first one if idx is 0) 
+//!         or 0 if there's none or it's out of reader's buffer.
+//!
+//! @note The first element is the head published when reader's section 
+//!       started, the list itself is never read.
+//-----------------------------------------------------------------------------
+int readerNext(ListReader* reader, size_t idx)
+{
+    assert(reader        != NULL);
+    assert(reader->nodes != NULL);
+    assert(idx < reader->capacity);
+
+    size_t next = idx == 0 ? reader->head : reader->nodes[idx].next;
+
+    return next < reader->capacity ? next : 0;
+}
+
+//-----------------------------------------------------------------------------
+//! Finds first occurrence of value walking from the head. The walk is 
+//! bounded by reader's capacity, so it ends even if links change under it.
+//!
+//! @param [in]  reader   
+//! @param [in]  value   
+//! @param [out] idx   
+//!
+//! @return whether or not value has been found.
+//-----------------------------------------------------------------------------
+bool readerFind(ListReader* reader, list_elem_t value, int* idx)
+{
+    assert(reader != NULL);
+    assert(idx    != NULL);
+
+    size_t index = readerNext(reader, 0);
+    for (size_t steps = 0; index != 0 && steps < reader->capacity; steps++)
+    {
+        if (reader->nodes[index].value == value)
+        {
+            *idx = index;
+            return true;
+        }
+
+        index = readerNext(reader, index);
+    }
+
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+//! Frees list's retired buffers that no read section can see anymore. Is 
+//! called on every retirement, but the writer can call it when idle too.
+//!
+//! @param [out] list   
+//-----------------------------------------------------------------------------
+void reclaimRetired(List* list)
+{
+    assert(list         != NULL);
+    assert(list->epochs != NULL);
+
+    ListEpochs* epochs = list->epochs;
+
+    uint64_t oldest = UINT64_MAX;
+    for (size_t i = 0; i < epochs->readersCount; i++)
+    {
+        uint64_t epoch = epochs->readers[i].load();
+        if (epoch != 0 && epoch < oldest) { oldest = epoch; }
+    }
+
+    size_t kept = 0;
+    for (size_t i = 0; i < epochs->retiredSize; i++)
+    {
+        if (epochs->retired[i].epoch <= oldest) { free(epochs->retired[i].block);          }
+        else                                    { epochs->retired[kept++] = epochs->retired[i]; }
+    }
+
+    epochs->retiredSize = kept;
+}
+
+//-----------------------------------------------------------------------------
+//! Publishes list's current buffer to readers and retires oldBlock. Read 
+//! sections that start after this can't see oldBlock.
+//!
+//! @param [out] list   
+//! @param [in]  oldBlock   
+//-----------------------------------------------------------------------------
+void listEpochRetire(List* list, void* oldBlock)
+{
+    assert(list         != NULL);
+    assert(list->epochs != NULL);
+
+    ListEpochs* epochs = list->epochs;
+
+    epochs->nodes.store(list->nodes);
+    uint64_t retireEpoch = epochs->epoch.fetch_add(1) + 1;
+
+    if (epochs->retiredSize == epochs->retiredCapacity)
+    {
+        size_t       newCapacity = epochs->retiredCapacity > 0 ? epochs->retiredCapacity * 2 : 4;
+        ListRetired* newRetired  = (ListRetired*) realloc(epochs->retired, newCapacity * sizeof(ListRetired));
+
+        if (newRetired == NULL)
+        {
+            // can't keep track of it, so it is leaked rather than freed early
+            setError(list, LIST_REALLOCATION_FAILED);
+            return;
+        }
+
+        epochs->retired         = newRetired;
+        epochs->retiredCapacity = newCapacity;
+    }
+
+    epochs->retired[epochs->retiredSize].block = oldBlock;
+    epochs->retired[epochs->retiredSize].epoch = retireEpoch;
+    epochs->retiredSize++;
+
+    reclaimRetired(list);
+}
+
+//-----------------------------------------------------------------------------
+//! Sets list's head and, if concurrent reads are enabled, publishes it to 
+//! read sections that start after this.
+//!
+//! @param [out] list   
+//! @param [in]  head   
+//-----------------------------------------------------------------------------
+void listSetHead(List* list, size_t head)
+{
+    assert(list != NULL);
+
+    list->head = head;
+
+    if (list->epochs != NULL) { list->epochs->head.store(head, std::memory_order_release); }
+}
+
+#ifdef LIST_SHARED_MEMORY_ENABLED
+
+//-----------------------------------------------------------------------------
+//! Opens list in the shared memory object called name, creating it if it
+//! doesn't exist. The object holds list's header, nodes and free slots
+//! bitmap, so every process that opens it works with the same list. Node 
+//! links are indices, so the mapping can be at any address in each process.
+//!
+//! @param [out] list   not constructed list
+//! @param [in]  name   name for shm_open, like "/my_list"
+//! @param [in]  capacity   starting capacity if the object is created
+//!
+//! @note Every access to list (including reading) must be done between
+//!       lockSharedList and unlockSharedList.
+//!
+//! @warning Generations, the hash index, chains, snapshots and concurrent 
+//!          reads keep per-process state and can't be enabled for a shared 
+//!          list.
+//!
+//! @return list if opened successfully or NULL otherwise.
+//-----------------------------------------------------------------------------
+List* openSharedList(List* list, const char* name, size_t capacity)
+{
+    assert(list != NULL);
+    assert(name != NULL);
+    assert(capacity > 0);
+
+    #ifdef LIST_DEBUG_MODE
+    list->name = name;
+    #endif
+
+    list->shared = new (std::nothrow) ListShared();
+    if (list->shared == NULL)
+    {
+        setError(list, LIST_CONSTRUCTION_FAILED);
+        return NULL;
+    }
+
+    int  fd      = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    bool created = fd >= 0;
+
+    if (!created && errno == EEXIST) { fd = shm_open(name, O_RDWR, 0); }
+
+    list->shared->fd = fd;
+
+    #ifdef LIST_DEBUG_MODE
+    list->status = LIST_STATUS_CONSTRUCTED;
+    #endif
+
+    if (fd < 0 || !(created ? listSharedCreate(list, capacity) : listSharedAttach(list)))
+    {
+        if (created) { shm_unlink(name); }
+
+        #ifdef LIST_DEBUG_MODE
+        list->status = LIST_STATUS_NOT_CONSTRUCTED;
+        #endif
+
+        listSharedClose(list);
+        setError(list, LIST_CONSTRUCTION_FAILED);
+        return NULL;
+    }
+
+    return list;
+}
+
+//-----------------------------------------------------------------------------
+//! Unmaps shared list. The list itself stays in the shared memory object for
+//! other processes until unlinkSharedList is called.
+//!
+//! @param [out] list   
+//-----------------------------------------------------------------------------
+void closeSharedList(List* list)
+{
+    assert(list         != NULL);
+    assert(list->shared != NULL);
+
+    listSharedClose(list);
+
+    list->size     = 0;
+    list->capacity = 0;
+
+    #ifdef LIST_DEBUG_MODE
+    list->status = LIST_STATUS_DESTRUCTED;
+    #endif
+}
+
+//-----------------------------------------------------------------------------
+//! Removes the shared memory object called name. Processes that have it 
+//! opened keep working with it until they close it.
+//!
+//! @param [in] name   
+//!
+//! @return whether or not the object has been removed.
+//-----------------------------------------------------------------------------
+bool unlinkSharedList(const char* name)
+{
+    assert(name != NULL);
+
+    return shm_unlink(name) == 0;
+}
+
+//-----------------------------------------------------------------------------
+//! Takes the process-shared lock of list and brings the process' view of it
+//! up to date. If another process has grown the list, the object is mapped 
+//! again (its generation tells that).
+//!
+//! @param [out] list   
+//!
+//! @note The lock is robust: if its owner died holding it, the lock is made
+//!       consistent and the list, as the owner last published it, is 
+//!       checked with listOk before it's used.
+//! @warning If the lock couldn't be taken, the object couldn't be mapped 
+//!          again or the dead owner has left the list broken, sets list's 
+//!          errorStatus (LIST_MEMORY_CORRUPTION or LIST_REALLOCATION_FAILED),
+//!          leaves the lock released and returns false. A broken list's 
+//!          errorStatus is published for other processes too.
+//!
+//! @return whether or not list has been locked.
+//-----------------------------------------------------------------------------
+bool lockSharedList(List* list)
+{
+    assert(list         != NULL);
+    assert(list->shared != NULL);
+
+    ListShared*      shared = list->shared;
+    pthread_mutex_t* lock   = &shared->header->lock;
+
+    int  error     = pthread_mutex_lock(lock);
+    bool ownerDied = error == EOWNERDEAD;
+
+    if (ownerDied) { error = pthread_mutex_consistent(lock); }
+
+    if (error != 0)
+    {
+        if (ownerDied) { pthread_mutex_unlock(lock); }
+
+        setError(list, LIST_MEMORY_CORRUPTION);
+        return false;
+    }
+
+    if (shared->generation != shared->header->generation)
+    {
+        // the lock is in the object, so it stays taken in the new mapping
+        if (!listSharedMap(list, shared->header->mappingSize))
+        {
+            pthread_mutex_unlock(lock);
+
+            setError(list, LIST_REALLOCATION_FAILED);
+            return false;
+        }
+
+        shared->generation = shared->header->generation;
+    }
+
+    listSharedLoad(list);
+
+    if (ownerDied && !listOk(list))
+    {
+        shared->header->errorStatus = list->errorStatus;
+        pthread_mutex_unlock(&shared->header->lock);
+
+        return false;
+    }
+
+    ASSERT_LIST_OK(list);
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//! Publishes the process' changes of list and releases its lock.
+//!
+//! @param [out] list   
+//-----------------------------------------------------------------------------
+void unlockSharedList(List* list)
+{
+    assert(list         != NULL);
+    assert(list->shared != NULL);
+
+    ASSERT_LIST_OK(list);
+
+    ListSharedHeader* header = list->shared->header;
+
+    header->size          = list->size;
+    header->capacity      = list->capacity;
+    header->head          = list->head;
+    header->tail          = list->tail;
+    header->free          = list->free;
+    header->freeWatermark = list->freeWatermark;
+    header->searchEnabled = list->searchEnabled;
+    header->errorStatus   = list->errorStatus;
+
+    pthread_mutex_unlock(&header->lock);
+}
+
+//-----------------------------------------------------------------------------
+//! Initializes the shared memory object just created by openSharedList.
+//!
+//! @param [out] list   
+//! @param [in]  capacity   
+//!
+//! @return whether or not the object has been initialized.
 //-----------------------------------------------------------------------------
-list_elem_t topBack(List* list)
+bool listSharedCreate(List* list, size_t capacity)
 {
-    ASSERT_LIST_OK(list);
+    assert(list         != NULL);
+    assert(list->shared != NULL);
 
-    return at(list, list->tail);
+    capacity = capacity + 1 > LIST_MINIMAL_CAPACITY ? capacity + 1 : LIST_MINIMAL_CAPACITY;
+
+    size_t bytes = listSharedBytes(capacity);
+
+    if (ftruncate(list->shared->fd, bytes) != 0) { return false; }
+    if (!listSharedMap(list, bytes))             { return false; }
+
+    ListSharedHeader* header = new (list->shared->header) ListSharedHeader();
+
+    pthread_mutexattr_t attributes;
+    pthread_mutexattr_init(&attributes);
+    pthread_mutexattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust (&attributes, PTHREAD_MUTEX_ROBUST);
+
+    int error = pthread_mutex_init(&header->lock, &attributes);
+    pthread_mutexattr_destroy(&attributes);
+
+    if (error != 0) { return false; }
+
+    header->mappingSize = bytes;
+    header->capacity    = capacity;
+
+    // ftruncate has zeroed the nodes and the free slots bitmap
+    listSharedLoad(list);
+
+    LIST_SET_CANARIES(list);
+
+    #ifdef LIST_POISONING_ENABLED
+    list->nodes[0].value = LIST_POISON;
+    #endif
+
+    list->searchEnabled = true;
+    list->freeWatermark = list->capacity;
+    listUpdateFree(list, 1);
+
+    pthread_mutex_lock(&header->lock);
+    header->ready.store(true, std::memory_order_release);
+    unlockSharedList(list);
+
+    return true;
 }
 
 //-----------------------------------------------------------------------------
+//! Maps the shared memory object opened by openSharedList that another 
+//! process has created, waiting for it to be initialized.
+//!
 //! @param [out] list   
 //!
-//! @return the first element in list.
+//! @return whether or not the object has been mapped.
 //-----------------------------------------------------------------------------
-list_elem_t topFront(List* list)
+bool listSharedAttach(List* list)
 {
-    ASSERT_LIST_OK(list);
+    assert(list         != NULL);
+    assert(list->shared != NULL);
 
-    return at(list, list->head);
+    struct stat status = {};
+    do
+    {
+        if (fstat(list->shared->fd, &status) != 0) { return false; }
+        sched_yield();
+    } while ((size_t) status.st_size < sizeof(ListSharedHeader));
+
+    if (!listSharedMap(list, status.st_size)) { return false; }
+
+    while (!list->shared->header->ready.load(std::memory_order_acquire)) { sched_yield(); }
+
+    // makes lockSharedList map all of the object
+    list->shared->generation = UINT64_MAX;
+
+    if (!lockSharedList(list)) { return false; }
+    unlockSharedList(list);
+
+    return true;
 }
 
 //-----------------------------------------------------------------------------
-//! Finds index and position of the first element with this value in list.
-//! 
-//! @param [in]  list   
-//! @param [in]  value   
-//! @param [out] idx   will be set to the index of the found element (starting 
-//!              from 1) or 0 in case there no such elements in the list.    
-//! @param [out] pos   will be set to the position of the found element (starting 
-//!              from 1) or 0 in case there no such elements in the list.  
+//! Maps size bytes of list's shared memory object, replacing the previous 
+//! mapping.
 //!
-//! @return whether or not element with this value has been found.
+//! @param [out] list   
+//! @param [in]  size   
+//!
+//! @note Doesn't update list's nodes and free slots bitmap.
+//!
+//! @return whether or not the object has been mapped.
 //-----------------------------------------------------------------------------
-bool find(List* list, list_elem_t value, int* idx, int* pos)
+bool listSharedMap(List* list, size_t size)
 {
-    ASSERT_LIST_OK(list);
+    assert(list         != NULL);
+    assert(list->shared != NULL);
 
-    int index = list->head;
-    for (size_t i = 1; i <= list->size; i++)
+    ListShared* shared  = list->shared;
+    void*       mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, shared->fd, 0);
+
+    if (mapping == MAP_FAILED) { return false; }
+
+    if (shared->header != NULL) { munmap(shared->header, shared->mappingSize); }
+
+    shared->header      = (ListSharedHeader*) mapping;
+    shared->mappingSize = size;
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//! Sets list's fields from its shared header and points its nodes and free
+//! slots bitmap into the current mapping.
+//!
+//! @param [out] list   
+//-----------------------------------------------------------------------------
+void listSharedLoad(List* list)
+{
+    assert(list         != NULL);
+    assert(list->shared != NULL);
+
+    ListSharedHeader* header = list->shared->header;
+
+    list->size          = header->size;
+    list->capacity      = header->capacity;
+    list->head          = header->head;
+    list->tail          = header->tail;
+    list->free          = header->free;
+    list->freeWatermark = header->freeWatermark;
+    list->searchEnabled = header->searchEnabled;
+    list->errorStatus   = header->errorStatus;
+
+    list->nodes   = listAlignNodes(header + 1);
+    list->freeMap = (uint64_t*) ((char*) header + listSharedFreeMapOffset(list->capacity));
+}
+
+//-----------------------------------------------------------------------------
+//! Grows list's shared memory object for newCapacity nodes. Other processes
+//! map it again when they lock the list next time.
+//!
+//! @param [out] list   
+//! @param [in]  newCapacity   
+//!
+//! @note Updates list's nodes and free slots bitmap, but not its capacity.
+//!
+//! @return pointer to the first node or NULL if the object couldn't grow.
+//-----------------------------------------------------------------------------
+ListNode* listSharedResize(List* list, size_t newCapacity)
+{
+    assert(list         != NULL);
+    assert(list->shared != NULL);
+    assert(newCapacity >= list->capacity);
+
+    ListShared* shared   = list->shared;
+    size_t      newBytes = listSharedBytes(newCapacity);
+
+    // the object never shrinks, other processes may still map all of it
+    if (newBytes > shared->mappingSize)
     {
-        if (list->nodes[index].value == value)
+        if (ftruncate(shared->fd, newBytes) != 0) { return NULL; }
+        if (!listSharedMap(list, newBytes))       { return NULL; }
+    }
+
+    char*  base     = (char*) shared->header;
+    size_t oldWords = listFreeMapWords(list->capacity);
+    size_t newWords = listFreeMapWords(newCapacity);
+
+    // the bitmap follows the nodes, so it moves further as they grow
+    uint64_t* newFreeMap = (uint64_t*) (base + listSharedFreeMapOffset(newCapacity));
+    memmove(newFreeMap, base + listSharedFreeMapOffset(list->capacity), oldWords * sizeof(uint64_t));
+    memset(newFreeMap + oldWords, 0, (newWords - oldWords) * sizeof(uint64_t));
+
+    shared->header->mappingSize = shared->mappingSize;
+    shared->header->generation++;
+    shared->generation = shared->header->generation;
+
+    list->nodes   = listAlignNodes(shared->header + 1);
+    list->freeMap = newFreeMap;
+
+    return list->nodes;
+}
+
+//-----------------------------------------------------------------------------
+//! Unmaps list's shared memory object and frees the process' state of it.
+//!
+//! @param [out] list   
+//-----------------------------------------------------------------------------
+void listSharedClose(List* list)
+{
+    assert(list         != NULL);
+    assert(list->shared != NULL);
+
+    ListShared* shared = list->shared;
+
+    if (shared->header != NULL) { munmap(shared->header, shared->mappingSize); }
+    if (shared->fd     >= 0)    { close(shared->fd);                          }
+
+    delete shared;
+
+    list->shared  = NULL;
+    list->nodes   = NULL;
+    list->freeMap = NULL;
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] capacity   
+//!
+//! @return offset of the free slots bitmap in the shared memory object of a 
+//!         list with capacity. The nodes are right after the header.
+//-----------------------------------------------------------------------------
+size_t listSharedFreeMapOffset(size_t capacity)
+{
+    size_t offset = sizeof(ListSharedHeader) + listNodesBytes(capacity);
+
+    return (offset + sizeof(uint64_t) - 1) / sizeof(uint64_t) * sizeof(uint64_t);
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] capacity   
+//!
+//! @return size of the shared memory object of a list with capacity.
+//-----------------------------------------------------------------------------
+size_t listSharedBytes(size_t capacity)
+{
+    return listSharedFreeMapOffset(capacity) + listFreeMapWords(capacity) * sizeof(uint64_t);
+}
+
+#endif
+
+#ifdef LIST_PROFILING_ENABLED
+
+static thread_local ListPerfCounters listPerfCounters;
+
+//-----------------------------------------------------------------------------
+//! @param [in] list   
+//! @param [in] op   
+//!
+//! @return list's totals of op since construction or the last resetProfile.
+//-----------------------------------------------------------------------------
+const ListOpProfile* getProfile(List* list, ListProfiledOp op)
+{
+    assert(list != NULL);
+    assert(op < LIST_PROFILED_OPS_COUNT);
+
+    return &list->profile[op];
+}
+
+//-----------------------------------------------------------------------------
+//! Zeroes all of list's profile.
+//!
+//! @param [out] list   
+//-----------------------------------------------------------------------------
+void resetProfile(List* list)
+{
+    assert(list != NULL);
+
+    for (size_t op = 0; op < LIST_PROFILED_OPS_COUNT; op++)
+    {
+        list->profile[op] = {};
+    }
+}
+
+//-----------------------------------------------------------------------------
+//! Opens a perf event group counting user space events of the calling 
+//! thread. Counters that the kernel, the CPU or perf_event_paranoid don't 
+//! allow are left out, so the group may be empty.
+//!
+//! @param [out] perf   
+//-----------------------------------------------------------------------------
+void listPerfOpen(ListPerfCounters* perf)
+{
+    assert(perf != NULL);
+
+    static const uint32_t types[LIST_COUNTERS_COUNT] = 
+    {
+        PERF_TYPE_HARDWARE,
+        PERF_TYPE_HW_CACHE,
+        PERF_TYPE_HARDWARE,
+        PERF_TYPE_HW_CACHE,
+        PERF_TYPE_HARDWARE,
+        PERF_TYPE_SOFTWARE
+    };
+
+    static const uint64_t configs[LIST_COUNTERS_COUNT] = 
+    {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_CACHE_L1D   | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_CACHE_DTLB  | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+        PERF_COUNT_HW_BRANCH_MISSES,
+        PERF_COUNT_SW_PAGE_FAULTS
+    };
+
+    perf->opened = true;
+    perf->leader = -1;
+    perf->count  = 0;
+
+    for (size_t i = 0; i < LIST_COUNTERS_COUNT; i++)
+    {
+        perf_event_attr attr = {};
+        attr.size           = sizeof(attr);
+        attr.type           = types[i];
+        attr.config         = configs[i];
+        attr.read_format    = PERF_FORMAT_GROUP;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+
+        int fd = (int) syscall(SYS_perf_event_open, &attr, 0, -1, perf->leader, PERF_FLAG_FD_CLOEXEC);
+
+        perf->fds  [i] = fd;
+        perf->slots[i] = fd >= 0 ? (int) perf->count : -1;
+
+        if (fd < 0) { continue; }
+
+        if (perf->leader < 0) { perf->leader = fd; }
+        perf->count++;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//! Reads the current values of the calling thread's counters.
+//!
+//! @param [out] perf   
+//! @param [out] counters   LIST_COUNTERS_COUNT values, unavailable ones 
+//!              are left as they are
+//!
+//! @return whether or not the group could be read.
+//-----------------------------------------------------------------------------
+bool listPerfRead(ListPerfCounters* perf, uint64_t* counters)
+{
+    assert(perf     != NULL);
+    assert(counters != NULL);
+
+    if (!perf->opened) { listPerfOpen(perf); }
+    if (perf->leader < 0) { return false; }
+
+    uint64_t buffer[1 + LIST_COUNTERS_COUNT] = {};
+
+    ssize_t bytes = read(perf->leader, buffer, sizeof(buffer));
+    if (bytes < (ssize_t) ((1 + perf->count) * sizeof(uint64_t))) { return false; }
+
+    for (size_t i = 0; i < LIST_COUNTERS_COUNT; i++)
+    {
+        if (perf->slots[i] >= 0) { counters[i] = buffer[1 + perf->slots[i]]; }
+    }
+
+    return true;
+}
+
+ListPerfCounters::~ListPerfCounters()
+{
+    for (size_t i = 0; opened && i < LIST_COUNTERS_COUNT; i++)
+    {
+        if (fds[i] >= 0) { close(fds[i]); }
+    }
+}
+
+ListProfileScope::ListProfileScope(List* list, ListProfiledOp op) : list(list), op(op)
+{
+    measured = listPerfRead(&listPerfCounters, start);
+
+    clock_gettime(CLOCK_MONOTONIC, &startTime);
+}
+
+ListProfileScope::~ListProfileScope()
+{
+    timespec endTime = {};
+    clock_gettime(CLOCK_MONOTONIC, &endTime);
+
+    uint64_t end[LIST_COUNTERS_COUNT] = {};
+    measured = measured && listPerfRead(&listPerfCounters, end);
+
+    ListOpProfile* profile = &list->profile[op];
+
+    profile->calls++;
+    profile->nanoseconds += (uint64_t) (endTime.tv_sec  - startTime.tv_sec) * 1000000000 + 
+                            (uint64_t)  endTime.tv_nsec - startTime.tv_nsec;
+
+    if (!measured) { return; }
+
+    for (size_t i = 0; i < LIST_COUNTERS_COUNT; i++)
+    {
+        if (listPerfCounters.slots[i] < 0) { continue; }
+
+        profile->counters[i] += end[i] - start[i];
+        profile->samples [i]++;
+    }
+}
+
+#endif
+
+//-----------------------------------------------------------------------------
+//! Starts walk for LIST_SLOW::walkMany and prefetches its first node.
+//!
+//! @param [out] state   
+//! @param [out] walk   
+//!
+//! @return whether or not walk needs walking (otherwise it's already answered).
+//-----------------------------------------------------------------------------
+bool listWalkStart(ListWalkState* state, ListWalk* walk)
+{
+    assert(state != NULL);
+    assert(walk  != NULL);
+
+    List* list = walk->list;
+    assert(list        != NULL);
+    assert(list->nodes != NULL);
+
+    state->walk     = walk;
+    state->backward = false;
+
+    if (walk->kind == LIST_WALK_FIND)
+    {
+        if (list->hashTable != NULL)
         {
-            *idx = index;
-            *pos = i;
+            int pos = 0;
+            find(list, walk->value, &walk->idx, &pos);
+            walk->pos = pos;
+
+            return false;
+        }
+
+        state->index = list->head;
+        state->step  = 1;
+        state->steps = list->size;
+    }
+    else
+    {
+        assert(walk->pos >= 1 && walk->pos <= list->size);
+
+        if (!list->searchEnabled)
+        {
+            walk->idx = walk->pos;
+            return false;
+        }
+
+        if (list->rankNodes != NULL)
+        {
+            walk->idx = listRankIndexAt(list, walk->pos);
+            return false;
+        }
+
+        state->backward = walk->pos > list->size / 2;
+        state->index    = state->backward ? list->tail : list->head;
+        state->step     = 0;
+        state->steps    = state->backward ? list->size - walk->pos : walk->pos - 1;
+    }
+
+    LIST_PREFETCH(&list->nodes[state->index]);
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//! Makes one step of walk started by listWalkStart. Node at state's index is
+//! expected to be prefetched by the previous step.
+//!
+//! @param [out] state   
+//!
+//! @return whether or not the walk has finished.
+//-----------------------------------------------------------------------------
+bool listWalkStep(ListWalkState* state)
+{
+    assert(state       != NULL);
+    assert(state->walk != NULL);
+
+    ListWalk* walk  = state->walk;
+    ListNode* nodes = walk->list->nodes;
+
+    if (walk->kind == LIST_WALK_FIND)
+    {
+        if (state->step > state->steps)
+        {
+            walk->idx = 0;
+            walk->pos = 0;
 
             return true;
         }
 
-        index = list->nodes[index].next;
+        if (nodes[state->index].value == walk->value)
+        {
+            walk->idx = state->index;
+            walk->pos = state->step;
+
+            return true;
+        }
+    }
+    else if (state->step == state->steps)
+    {
+        walk->idx = state->index;
+
+        return true;
     }
 
-    *idx = 0;
-    *pos = 0;
+    state->index = state->backward ? nodes[state->index].prev : nodes[state->index].next;
+    state->step++;
+
+    LIST_PREFETCH(&nodes[state->index]);
+
+    return false;
+}
+
+int listCompareQueryIdx(const void* first, const void* second)
+{
+    size_t firstIdx  = ((const ListQuery*) first)->idx;
+    size_t secondIdx = ((const ListQuery*) second)->idx;
+
+    return (firstIdx > secondIdx) - (firstIdx < secondIdx);
+}
+
+int listCompareQueryValue(const void* first, const void* second)
+{
+    list_elem_t firstValue  = ((const ListQuery*) first)->value;
+    list_elem_t secondValue = ((const ListQuery*) second)->value;
 
-    return false;
+    return (firstValue > secondValue) - (firstValue < secondValue);
 }
 
 namespace LIST_SLOW
@@ -942,61 +5399,46 @@ namespace LIST_SLOW
 void switchToIndexSearch(List* list)
 {
     ASSERT_LIST_OK(list);
+    assert(list->batch == NULL);
 
-    ListNode* newNodes = (ListNode*) ((char*)calloc(1, list->capacity * sizeof(ListNode) 
-
-                                                       #ifdef LIST_CANARIES_ENABLED
-                                                       + sizeof(LIST_ARRAY_CANARY_L) 
-                                                       + sizeof(LIST_ARRAY_CANARY_R) 
-                                                       #endif 
-
-                                                    )
-
-                                                    #ifdef LIST_CANARIES_ENABLED
-                                                    + sizeof(LIST_ARRAY_CANARY_L)
-                                                    #endif 
-                                     );
-    assert(newNodes != NULL);
-
-    newNodes[0] = list->nodes[0];
-
-    for (size_t i = 1; i <= list->size; i++)
-    {
-        newNodes[i] = list->nodes[list->head];
-
-        newNodes[i].next = i < list->size ? i + 1 : 0;
-        newNodes[i].prev = i > 1          ? i - 1 : 0;
-
-        list->head = list->nodes[list->head].next;
-    }
-
-    #ifdef LIST_CANARIES_ENABLED
-    free((char*)list->nodes - sizeof(LIST_ARRAY_CANARY_L));
-    #else
-    free(list->nodes);
-    #endif
+    LIST_PROFILE(list, LIST_PROFILE_LINEARIZE);
 
-    list->nodes = newNodes;
+    listLinearize(list, true);
 
-    list->head = list->size > 0 ? 1 : 0;
-    list->tail = list->size;
+    ASSERT_LIST_OK(list);
+}
 
-    list->free = 0;
-    listUpdateFree(list, list->size + 1);
+//-----------------------------------------------------------------------------
+//! Sorts list and optimizes findIndex and findPos functions in one pass over
+//! the buffer. Same as sortList followed by switchToIndexSearch, except that
+//! prev links aren't restored before the buffer is rewritten.
+//!
+//! @param [out] list   
+//! @param [in]  less   returns whether or not first argument goes before the 
+//!              second one, NULL to sort in ascending order
+//-----------------------------------------------------------------------------
+void sortAndLinearize(List* list, ListComparator less)
+{
+    ASSERT_LIST_OK(list);
+    assert(list->batch == NULL);
 
-    LIST_SET_CANARIES(list);    
+    LIST_PROFILE(list, LIST_PROFILE_LINEARIZE);
 
-    list->searchEnabled = false;
+    listSortLinks(list, less != NULL ? less : listDefaultLess);
+    listLinearize(list, false);
 
     ASSERT_LIST_OK(list);
 }
 
 //-----------------------------------------------------------------------------
 //! Finds index of the element in list's buffer with position pos in list.
+//! Walks from the end of list closest to pos.
 //! 
 //! @param [in] list   
 //! @param [in] pos   
 //!
+//! @note Takes O(log(n)) if list's rank index is enabled.
+//!
 //! @return found index.
 //-----------------------------------------------------------------------------
 int findIndex(List* list, size_t pos)
@@ -1006,8 +5448,23 @@ int findIndex(List* list, size_t pos)
     assert(list->size >= pos);
     assert(pos >= 1);
 
+    LIST_PROFILE(list, LIST_PROFILE_FIND_INDEX);
+
     if (!list->searchEnabled) { return pos; }
 
+    if (list->rankNodes != NULL) { return listRankIndexAt(list, pos); }
+
+    if (pos > list->size / 2)
+    {
+        size_t index = list->tail;
+        for (size_t i = list->size; i > pos; i--)
+        {
+            index = list->nodes[index].prev;
+        }
+
+        return index;
+    }
+
     size_t index = list->head;
     for (size_t i = 1; i < pos; i++)
     {
@@ -1023,6 +5480,8 @@ int findIndex(List* list, size_t pos)
 //! @param [in] list   
 //! @param [in] idx   
 //!
+//! @note Takes O(log(n)) if list's rank index is enabled.
+//!
 //! @return found position.
 //-----------------------------------------------------------------------------
 int findPos(List* list, size_t idx)
@@ -1030,10 +5489,29 @@ int findPos(List* list, size_t idx)
     assert(list != NULL);
     assert(list->nodes != NULL);
 
-    if (list->nodes[idx].prev == -1) { return 0; }
+    LIST_PROFILE(list, LIST_PROFILE_FIND_POS);
+
+    if (listIsFree(list, idx)) { return 0; }
 
     if (!list->searchEnabled) { return idx; }
 
+    if (list->rankNodes != NULL) { return listRankPosOf(list, idx); }
+
+    if (list->twoEndedSearch)
+    {
+        // walks to both ends at once, the one reached first tells the position
+        size_t back  = idx;
+        size_t front = idx;
+        for (size_t steps = 0; ; steps++)
+        {
+            if (list->nodes[back].prev  == 0) { return steps + 1; }
+            if (list->nodes[front].next == 0) { return list->size - steps; }
+
+            back  = list->nodes[back].prev;
+            front = list->nodes[front].next;
+        }
+    }
+
     int pos = 1;
     while (list->nodes[idx].prev != 0)
     {
@@ -1043,6 +5521,311 @@ int findPos(List* list, size_t idx)
 
     return pos;
 }
+
+//-----------------------------------------------------------------------------
+//! Same as findIndex for each of positions, but all of them are found in a 
+//! single walk over list, so it takes O(size + count).
+//! 
+//! @param [in]  list   
+//! @param [in]  positions   sorted in ascending order, each one from 1 to 
+//!              list's size
+//! @param [out] outIdx   outIdx[i] is set to the index of positions[i]
+//! @param [in]  count   
+//-----------------------------------------------------------------------------
+void findIndexMany(List* list, const size_t* positions, int* outIdx, size_t count)
+{
+    assert(list        != NULL);
+    assert(list->nodes != NULL);
+    assert(count == 0 || (positions != NULL && outIdx != NULL));
+
+    size_t index = list->head;
+    size_t pos   = 1;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        assert(positions[i] >= 1 && positions[i] <= list->size);
+        assert(i == 0 || positions[i - 1] <= positions[i]);
+
+        if (!list->searchEnabled)
+        {
+            outIdx[i] = positions[i];
+            continue;
+        }
+
+        for (; pos < positions[i]; pos++)
+        {
+            index = list->nodes[index].next;
+        }
+
+        outIdx[i] = index;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//! Same as findPos for each of idxs, but all of them are found in a single 
+//! walk over list, so it takes O(size + count * log(count)).
+//! 
+//! @param [in]  list   
+//! @param [in]  idxs   indices in list's buffer, in any order
+//! @param [out] outPos   outPos[i] is set to the position of idxs[i] or to 0 
+//!              if idxs[i] is a free slot
+//! @param [in]  count   
+//!
+//! @note if calloc returned NULL then sets list's errorStatus to 
+//!       LIST_REALLOCATION_FAILED and leaves outPos untouched.
+//-----------------------------------------------------------------------------
+void findPosMany(List* list, const size_t* idxs, int* outPos, size_t count)
+{
+    assert(list        != NULL);
+    assert(list->nodes != NULL);
+    assert(count == 0 || (idxs != NULL && outPos != NULL));
+
+    if (count == 0) { return; }
+
+    if (!list->searchEnabled)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            assert(idxs[i] < list->capacity);
+            outPos[i] = !listIsFree(list, idxs[i]) ? idxs[i] : 0;
+        }
+
+        return;
+    }
+
+    ListQuery* queries = (ListQuery*) calloc(count, sizeof(ListQuery));
+    uint64_t*  queried = (uint64_t*)  calloc(listFreeMapWords(list->capacity), sizeof(uint64_t));
+
+    if (queries == NULL || queried == NULL)
+    {
+        free(queried);
+        free(queries);
+
+        setError(list, LIST_REALLOCATION_FAILED);
+        return;
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        assert(idxs[i] < list->capacity);
+
+        queries[i].idx   = idxs[i];
+        queries[i].order = i;
+        outPos[i]        = 0;
+
+        queried[idxs[i] / LIST_FREE_MAP_WORD_BITS] |= (uint64_t) 1 << (idxs[i] % LIST_FREE_MAP_WORD_BITS);
+    }
+
+    qsort(queries, count, sizeof(ListQuery), listCompareQueryIdx);
+
+    size_t index = list->head;
+    for (size_t pos = 1; index != 0; pos++)
+    {
+        if ((queried[index / LIST_FREE_MAP_WORD_BITS] >> (index % LIST_FREE_MAP_WORD_BITS)) & 1)
+        {
+            size_t left  = 0;
+            size_t right = count;
+            while (left < right)
+            {
+                size_t middle = (left + right) / 2;
+
+                if (queries[middle].idx < index) { left  = middle + 1; }
+                else                             { right = middle;     }
+            }
+
+            for (size_t i = left; i < count && queries[i].idx == index; i++)
+            {
+                outPos[queries[i].order] = pos;
+            }
+        }
+
+        index = list->nodes[index].next;
+    }
+
+    free(queried);
+    free(queries);
+}
+
+//-----------------------------------------------------------------------------
+//! Same as find for each of values, but all of them are found in a single 
+//! walk over list, so it takes O(size + count * log(count)).
+//! 
+//! @param [in]  list   
+//! @param [in]  values   
+//! @param [out] outIdx   outIdx[i] is set to the index of the first element 
+//!              equal to values[i] or to 0 if there's none
+//! @param [out] outPos   outPos[i] is set to the position of the first element
+//!              equal to values[i] or to 0 if there's none. Can be NULL.
+//! @param [in]  count   
+//!
+//! @note If list is linearized and has the hash index, every value is 
+//!       answered by the index without walking, in O(count) on average.
+//! @note if calloc returned NULL then sets list's errorStatus to 
+//!       LIST_REALLOCATION_FAILED, leaves outIdx and outPos untouched and 
+//!       returns 0.
+//!
+//! @return number of values found in list.
+//-----------------------------------------------------------------------------
+size_t findMany(List* list, const list_elem_t* values, int* outIdx, int* outPos, size_t count)
+{
+    assert(list        != NULL);
+    assert(list->nodes != NULL);
+    assert(count == 0 || (values != NULL && outIdx != NULL));
+
+    if (count == 0) { return 0; }
+
+    if (list->hashTable != NULL && !list->searchEnabled)
+    {
+        size_t found = 0;
+
+        for (size_t i = 0; i < count; i++)
+        {
+            // if linearized, the first element is the one with the least index
+            int first = list->hashTable[listHashLookup(list, values[i])];
+
+            for (int index = first != 0 ? list->hashChain[first] : 0; index != 0; index = list->hashChain[index])
+            {
+                if (index < first) { first = index; }
+            }
+
+            outIdx[i] = first;
+            if (outPos != NULL) { outPos[i] = first; }
+
+            found += first != 0;
+        }
+
+        return found;
+    }
+
+    // equal values are grouped by sorting, then each group gets a slot in a 
+    // hash table, so that every element of list is checked in O(1)
+    size_t tableSize = 1;
+    while (tableSize < 2 * count) { tableSize *= 2; }
+
+    ListQuery* queries = (ListQuery*) calloc(count,     sizeof(ListQuery));
+    size_t*    table   = (size_t*)    calloc(tableSize, sizeof(size_t));
+
+    if (queries == NULL || table == NULL)
+    {
+        free(table);
+        free(queries);
+
+        setError(list, LIST_REALLOCATION_FAILED);
+        return 0;
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        queries[i].value = values[i];
+        queries[i].order = i;
+
+        outIdx[i] = 0;
+        if (outPos != NULL) { outPos[i] = 0; }
+    }
+
+    qsort(queries, count, sizeof(ListQuery), listCompareQueryValue);
+
+    size_t groupsLeft = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (queries[i].value != queries[i].value)              { continue; }
+        if (i > 0 && queries[i - 1].value == queries[i].value) { continue; }
+
+        size_t slot = listHashValue(queries[i].value) & (tableSize - 1);
+        while (table[slot] != 0) { slot = (slot + 1) & (tableSize - 1); }
+
+        table[slot] = i + 1;
+        groupsLeft++;
+    }
+
+    size_t found = 0;
+    size_t index = list->head;
+    for (size_t pos = 1; index != 0 && groupsLeft > 0; pos++)
+    {
+        list_elem_t value = list->nodes[index].value;
+
+        size_t slot = listHashValue(value) & (tableSize - 1);
+        while (table[slot] != 0 && !(queries[table[slot] - 1].value == value))
+        {
+            slot = (slot + 1) & (tableSize - 1);
+        }
+
+        // a group is answered as soon as its first query gets an index
+        if (table[slot] != 0 && outIdx[queries[table[slot] - 1].order] == 0)
+        {
+            for (size_t i = table[slot] - 1; i < count && queries[i].value == value; i++)
+            {
+                outIdx[queries[i].order] = index;
+                if (outPos != NULL) { outPos[queries[i].order] = pos; }
+
+                found++;
+            }
+
+            groupsLeft--;
+        }
+
+        index = list->nodes[index].next;
+    }
+
+    free(table);
+    free(queries);
+
+    return found;
+}
+
+//-----------------------------------------------------------------------------
+//! Runs finds and findIndex'es over any lists, keeping up to inFlight walks
+//! going at once. A walk takes one step at a time, prefetching its next node,
+//! and hands over to the next walk, so that cache misses of all the walks in
+//! flight overlap instead of stalling one after another.
+//!
+//! @param [out] walks   walks[i].idx (and walks[i].pos for LIST_WALK_FIND)
+//!              are set to what find or findIndex would return
+//! @param [in]  count   
+//! @param [in]  inFlight   number of walks to interleave, at most 
+//!              LIST_MAX_WALKS_IN_FLIGHT are used
+//!
+//! @note Walks resolved without walking (by list's hash or rank index or in
+//!       linearized list) are answered immediately.
+//-----------------------------------------------------------------------------
+void walkMany(ListWalk* walks, size_t count, size_t inFlight)
+{
+    assert(count == 0 || walks != NULL);
+    assert(inFlight > 0);
+
+    if (inFlight > LIST_MAX_WALKS_IN_FLIGHT) { inFlight = LIST_MAX_WALKS_IN_FLIGHT; }
+
+    ListWalkState states[LIST_MAX_WALKS_IN_FLIGHT] = {};
+    size_t        active   = 0;
+    size_t        nextWalk = 0;
+
+    while (active < inFlight && nextWalk < count)
+    {
+        if (listWalkStart(&states[active], &walks[nextWalk++])) { active++; }
+    }
+
+    while (active > 0)
+    {
+        for (size_t i = 0; i < active; )
+        {
+            if (!listWalkStep(&states[i])) 
+            { 
+                i++; 
+                continue; 
+            }
+
+            // a finished walk's place goes to a new walk or the last one
+            bool started = false;
+            while (!started && nextWalk < count)
+            {
+                started = listWalkStart(&states[i], &walks[nextWalk++]);
+            }
+
+            if (started) { i++; }
+            else         { states[i] = states[--active]; }
+        }
+    }
+}
     
 }
 
@@ -1092,9 +5875,21 @@ bool listOk(List* list)
         return false;
     }
 
-    if (listFreeLoop(list))
+    if (!listChainsOk(list))
+    {
+        setError(list, LIST_LOOP);
+        return false;
+    }
+
+    if (!listRankOk(list))
+    {
+        setError(list, LIST_MEMORY_CORRUPTION);
+        return false;
+    }
+
+    if (!listFreeMapOk(list))
     {
-        setError(list, LIST_FREE_LIST_LOOP);
+        setError(list, LIST_FREE_MAP_CORRUPTED);
         return false;
     }
 
@@ -1159,6 +5954,93 @@ void dumpPrintErrors(List* list, const char* indentation)
     }
 }
 
+#ifdef LIST_PROFILING_ENABLED
+//-----------------------------------------------------------------------------
+//! @param [in] op   
+//!
+//! @return op's name for dump.
+//-----------------------------------------------------------------------------
+const char* listProfiledOpStr(ListProfiledOp op)
+{
+    switch (op)
+    {
+        case LIST_PROFILE_INSERT:     return "insert";
+        case LIST_PROFILE_REMOVE:     return "remove";
+        case LIST_PROFILE_MOVE:       return "move";
+        case LIST_PROFILE_FIND:       return "find";
+        case LIST_PROFILE_FIND_INDEX: return "findIndex";
+        case LIST_PROFILE_FIND_POS:   return "findPos";
+        case LIST_PROFILE_RESIZE:     return "resize";
+        case LIST_PROFILE_LINEARIZE:  return "linearize";
+        case LIST_PROFILE_SORT:       return "sort";
+
+        default: return NULL;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] counter   
+//!
+//! @return counter's name for dump.
+//-----------------------------------------------------------------------------
+const char* listCounterStr(ListCounter counter)
+{
+    switch (counter)
+    {
+        case LIST_COUNTER_CYCLES:        return "cycles";
+        case LIST_COUNTER_L1D_MISSES:    return "L1d misses";
+        case LIST_COUNTER_LLC_MISSES:    return "LLC misses";
+        case LIST_COUNTER_DTLB_MISSES:   return "dTLB misses";
+        case LIST_COUNTER_BRANCH_MISSES: return "branch misses";
+        case LIST_COUNTER_PAGE_FAULTS:   return "page faults";
+
+        default: return NULL;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//! Prints average cost per call of every operation type list has done. 
+//! Counters that couldn't be read are printed as n/a.
+//!
+//! @param [in] list   
+//-----------------------------------------------------------------------------
+void dumpProfile(List* list)
+{
+    assert(list != NULL);
+
+    LG_Write("    profile (per call, callees included)\n"
+             "    {\n");
+
+    for (size_t op = 0; op < LIST_PROFILED_OPS_COUNT; op++)
+    {
+        ListOpProfile* profile = &list->profile[op];
+        if (profile->calls == 0) { continue; }
+
+        LG_Write("        %-10s: calls=%lu, ns=%.1lf", 
+                 listProfiledOpStr((ListProfiledOp) op), 
+                 profile->calls, 
+                 (double) profile->nanoseconds / profile->calls);
+
+        for (size_t i = 0; i < LIST_COUNTERS_COUNT; i++)
+        {
+            if (profile->samples[i] == 0)
+            {
+                LG_Write(", %s=n/a", listCounterStr((ListCounter) i));
+            }
+            else
+            {
+                LG_Write(", %s=%.2lf", listCounterStr((ListCounter) i), 
+                         (double) profile->counters[i] / profile->samples[i]);
+            }
+        }
+
+        LG_Write("\n");
+    }
+
+    LG_Write("    }\n");
+}
+#endif
+
 void dumpGraph(List* list)
 {
     assert(list != NULL);
@@ -1187,7 +6069,7 @@ void dumpGraph(List* list)
         fprintf(graphFile, "\tNODE%u [label=\"{", i);
 
         // if not free node
-        if (list->nodes[i].prev != -1)
+        if (!listIsFree(list, i))
         {
             fprintf(graphFile,
                     "[%u] %lg|{pos\\n%d|",
@@ -1211,8 +6093,8 @@ void dumpGraph(List* list)
         else                          { fprintf(graphFile, "%d", list->nodes[i].prev); }
 
         // if not free node
-        if (list->nodes[i].prev != -1) { fprintf(graphFile, "}}\"];\n"); }
-        else                           { fprintf(graphFile, "}}\", fillcolor=\"#FFA07A\"];\n"); }
+        if (!listIsFree(list, i)) { fprintf(graphFile, "}}\"];\n"); }
+        else                      { fprintf(graphFile, "}}\", fillcolor=\"#FFA07A\"];\n"); }
 
         if (i < list->capacity - 1) 
         { 
@@ -1222,7 +6104,7 @@ void dumpGraph(List* list)
 
     for (size_t i = 1; i < list->capacity; i++)
     {
-        if (list->nodes[i].prev != -1 && list->nodes[list->nodes[i].next].prev != -1)
+        if (!listIsFree(list, i) && !listIsFree(list, list->nodes[i].next))
         {
             if (list->nodes[i].next != 0)
             {
@@ -1332,7 +6214,7 @@ void dump(List* list)
         {
             LG_Write("        ![%lu]\t= ", i);
         }
-        else if (list->nodes[i].prev != -1)
+        else if (!listIsFree(list, i))
         {
             LG_Write("        *[%lu]\t= ", i);
         }
@@ -1356,6 +6238,10 @@ void dump(List* list)
     }
        
     LG_Write("    }\n");
+
+    #ifdef LIST_PROFILING_ENABLED
+    dumpProfile(list);
+    #endif
      
     dumpGraph(list);
      
@@ -1,3 +1,6 @@
+#ifndef LIST_H
+#define LIST_H
+
 #include <stdint.h>
 #include <math.h>
 
@@ -5,7 +8,7 @@ typedef double list_elem_t;
 
 #ifdef LIST_DEBUG_MODE
 
-#define ASSERT_LIST_OK(list) if(list == NULL || !listOk(list)) { dump(list); LG_Close(); assert(! "OK"); }
+#define ASSERT_LIST_OK(list) if(list == NULL || (list->batch == NULL && !listOk(list))) { dump(list); LG_Close(); assert(! "OK"); }
 #define LIST_POISON            nan("")
 #define IS_LIST_POISON(value)  isnan(value)
 #define LIST_CANARIES_ENABLED
@@ -18,12 +21,32 @@ typedef double list_elem_t;
 #define LIST_POISONING_ENABLED
 #endif
 
+#if defined(__GNUC__) || defined(__clang__)
+#define LIST_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define LIST_PREFETCH(address)
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#define LIST_SHARED_MEMORY_ENABLED
+#endif
+
+#if defined(LIST_PROFILING_MODE) && defined(__linux__)
+#define LIST_PROFILING_ENABLED
+#endif
+
 #ifdef LIST_CANARIES_ENABLED
 static uint32_t LIST_ARRAY_CANARY_L = 0xBADC0FFE;
 static uint32_t LIST_ARRAY_CANARY_R = 0xDEADBEEF;
 #endif
 
-static size_t      LIST_DEFAULT_CAPACITY    = 16;
+static const size_t LIST_DEFAULT_CAPACITY      = 16;
+static const double LIST_EXPAND_MULTIPLIER     = 1.8;
+static const size_t LIST_PAGE_SIZE             = 4096;
+static const size_t LIST_HUGE_PAGE_SIZE        = 2 * 1024 * 1024;
+static const size_t LIST_NODES_ALIGNMENT       = 64;
+static const size_t LIST_FREED_STACK_SIZE      = 64;
+
 static const char* LIST_GRAPH_TXT_FILE_NAME = "list_dump.txt";
 static const char* LIST_GRAPH_IMG_FILE_NAME = "list_dump.svg";
 static const char* LIST_LOG_FOLDER          = "log/";
@@ -42,7 +65,7 @@ enum ListError
     LIST_CONSTRUCTION_FAILED = 0x004,
     LIST_REALLOCATION_FAILED = 0x008,
     LIST_MEMORY_CORRUPTION   = 0x010,
-    LIST_FREE_LIST_LOOP      = 0x020,
+    LIST_FREE_MAP_CORRUPTED  = 0x020,
     LIST_LOOP                = 0x040,
     LIST_ACCESSING_ZERO      = 0x080
 
@@ -53,6 +76,69 @@ enum ListError
     #endif
 };
 
+enum ListGrowthPolicy
+{
+    LIST_GROWTH_GEOMETRIC,
+    LIST_GROWTH_FIXED_STEP,
+    LIST_GROWTH_PAGE_ALIGNED,
+    LIST_GROWTH_HUGE_PAGE_ALIGNED
+};
+
+enum ListAllocationPolicy
+{
+    LIST_ALLOCATION_LIFO,
+    LIST_ALLOCATION_BLOCKED,
+    LIST_ALLOCATION_NEAREST
+};
+
+enum ListWalkKind
+{
+    LIST_WALK_FIND,
+    LIST_WALK_FIND_INDEX
+};
+
+#ifdef LIST_PROFILING_ENABLED
+enum ListProfiledOp
+{
+    LIST_PROFILE_INSERT,
+    LIST_PROFILE_REMOVE,
+    LIST_PROFILE_MOVE,
+    LIST_PROFILE_FIND,
+    LIST_PROFILE_FIND_INDEX,
+    LIST_PROFILE_FIND_POS,
+    LIST_PROFILE_RESIZE,
+    LIST_PROFILE_LINEARIZE,
+    LIST_PROFILE_SORT,
+
+    LIST_PROFILED_OPS_COUNT
+};
+
+enum ListCounter
+{
+    LIST_COUNTER_CYCLES,
+    LIST_COUNTER_L1D_MISSES,
+    LIST_COUNTER_LLC_MISSES,
+    LIST_COUNTER_DTLB_MISSES,
+    LIST_COUNTER_BRANCH_MISSES,
+    LIST_COUNTER_PAGE_FAULTS,
+
+    LIST_COUNTERS_COUNT
+};
+
+//-----------------------------------------------------------------------------
+//! Totals of one operation type over its calls. counters[i] is summed over
+//! samples[i] calls only, the ones made while counter i could be read (it
+//! may be unavailable on the machine or to the calling thread).
+//-----------------------------------------------------------------------------
+struct ListOpProfile
+{
+    uint64_t calls                         = 0;
+    uint64_t nanoseconds                   = 0;
+    uint64_t counters[LIST_COUNTERS_COUNT] = {};
+    uint64_t samples [LIST_COUNTERS_COUNT] = {};
+};
+#endif
+
 #ifdef LIST_DEBUG_MODE
 enum ListStatus
 {
@@ -63,6 +149,35 @@ enum ListStatus
 #endif
 
 struct ListNode;
+struct ListBatch;
+struct ListChunk;
+struct ListSnapshot;
+struct ListEpochs;
+struct ListLink;
+struct ListShared;
+struct ListRankNode;
+
+//-----------------------------------------------------------------------------
+//! Stable reference to a list's element. Stays valid until the element is
+//! removed (or moved by LIST_SLOW::switchToIndexSearch), after which any
+//! access through it fails in O(1) instead of touching the slot's new owner.
+//-----------------------------------------------------------------------------
+struct ListHandle
+{
+    size_t   index      = 0;
+    uint32_t generation = 0;
+};
+
+//-----------------------------------------------------------------------------
+//! Called for every element whose index changes when the list's buffer is
+//! rewritten. oldHandle is no longer valid by the time it is called.
+//-----------------------------------------------------------------------------
+typedef void (*ListRemapCallback)(ListHandle oldHandle, ListHandle newHandle, void* context);
+
+//-----------------------------------------------------------------------------
+//! Returns whether or not first should go before second.
+//-----------------------------------------------------------------------------
+typedef bool (*ListComparator)(list_elem_t first, list_elem_t second);
 
 struct List
 {
@@ -71,6 +186,7 @@ struct List
     #endif
 
     ListNode*  nodes         = NULL;
+    void*      nodesBlock    = NULL;
     size_t     size          = 0;
     size_t     capacity      = 0;
 
@@ -80,9 +196,87 @@ struct List
     bool       searchEnabled = true;
     uint32_t   errorStatus   = 0;
 
+    ListGrowthPolicy  growthPolicy  = LIST_GROWTH_GEOMETRIC;
+    double            growthFactor  = LIST_EXPAND_MULTIPLIER;
+    size_t            growthStep    = 0;
+
+    bool              twoEndedSearch = false;
+
+    ListAllocationPolicy allocationPolicy = LIST_ALLOCATION_LIFO;
+    uint64_t*            freeMap          = NULL;
+    size_t               freeWatermark    = 0;
+
+    size_t               freedStack[LIST_FREED_STACK_SIZE] = {};
+    size_t               freedStackTop                     = 0;
+    size_t               freedStackSize                    = 0;
+
+    uint32_t*         generations   = NULL;
+    ListRemapCallback remapCallback = NULL;
+    void*             remapContext  = NULL;
+
+    int*              hashTable     = NULL;
+    int*              hashChain     = NULL;
+    size_t            hashTableSize = 0;
+
+    ListRankNode*     rankNodes     = NULL;
+    size_t            rankRoot      = 0;
+    uint32_t          rankSeed      = 0;
+
+    ListBatch*        batch         = NULL;
+
+    ListChunk**       snapshotChunks  = NULL;
+    size_t            snapshotVersion = 0;
+
+    ListEpochs*       epochs        = NULL;
+
+    ListLink*         chainLinks    = NULL;
+    size_t            chainsCount   = 1;
+
+    ListShared*       shared        = NULL;
+
+    #ifdef LIST_PROFILING_ENABLED
+    ListOpProfile     profile[LIST_PROFILED_OPS_COUNT] = {};
+    #endif
+
     #ifdef LIST_DEBUG_MODE
     ListStatus status = LIST_STATUS_NOT_CONSTRUCTED;
     #endif
+
+    List() = default;
+
+    // copying would share the buffers, use cloneList instead
+    List(const List& other)            = delete;
+    List& operator=(const List& other) = delete;
+
+    List(List&& other) noexcept;
+    List& operator=(List&& other) noexcept;
+};
+
+//-----------------------------------------------------------------------------
+//! Read section of a thread reading a list concurrently with its writer. 
+//! Keeps the buffer the section started with allocated until it ends and 
+//! walks it from the head published at that moment.
+//-----------------------------------------------------------------------------
+struct ListReader
+{
+    List*     list     = NULL;
+    size_t    slot     = 0;
+    ListNode* nodes    = NULL;
+    size_t    capacity = 0;
+    size_t    head     = 0;
+};
+
+//-----------------------------------------------------------------------------
+//! One find (LIST_WALK_FIND) or LIST_SLOW::findIndex (LIST_WALK_FIND_INDEX)
+//! for LIST_SLOW::walkMany to run. Walks of a call can be over any lists.
+//-----------------------------------------------------------------------------
+struct ListWalk
+{
+    List*        list  = NULL;
+    ListWalkKind kind  = LIST_WALK_FIND;
+    list_elem_t  value = 0;
+    size_t       pos   = 0;
+    int          idx   = 0;
 };
 
 #ifdef LIST_DEBUG_MODE
@@ -104,6 +298,8 @@ struct List
 #endif
 
 void        destructList   (List* list);
+List*       cloneList      (List* list, List* clone);
+List*       cloneLinearized(List* list, List* clone);
 
 List*       newList        (size_t bufferSize);
 List*       newList        ();
@@ -111,6 +307,9 @@ void        deleteList     (List* list);
 
 size_t      getSize        (List* list);
 size_t      getCapacity    (List* list);
+bool        reserve        (List* list, size_t size);
+void        setGrowthPolicy(List* list, ListGrowthPolicy policy, double parameter);
+void        setAllocationPolicy(List* list, ListAllocationPolicy policy);
 bool        isEmpty        (List* list);
 uint32_t    getErrorStatus (List* list);
 const char* getErrorStr    (ListError error);
@@ -129,7 +328,71 @@ list_elem_t popFront       (List* list);
 list_elem_t topBack        (List* list);
 list_elem_t topFront       (List* list);
 
-bool        find           (List* list, list_elem_t value, int* idx, int* pos);
+bool        find              (List* list, list_elem_t value, int* idx, int* pos);
+int         insertSorted      (List* list, list_elem_t value);
+int         lowerBound        (List* list, list_elem_t value);
+int         upperBound        (List* list, list_elem_t value);
+bool        loadSorted        (List* list, const list_elem_t* values, size_t count);
+void        sortList          (List* list, ListComparator less);
+void        setTwoEndedSearch (List* list, bool enabled);
+
+bool        enableGenerations (List* list);
+void        setRemapCallback  (List* list, ListRemapCallback callback, void* context);
+ListHandle  getHandle         (List* list, size_t idx);
+bool        isHandleValid     (List* list, ListHandle handle);
+bool        atHandle          (List* list, ListHandle handle, list_elem_t* value);
+bool        removeHandle      (List* list, ListHandle handle, list_elem_t* value);
+ListHandle  insertAfterHandle (List* list, list_elem_t value, ListHandle handle);
+
+bool        enableChains      (List* list, size_t count);
+int         insertAfterChain  (List* list, list_elem_t value, size_t idx, size_t chain);
+void        moveAfter         (List* list, size_t idx, size_t after);
+void        moveAfterChain    (List* list, size_t idx, size_t after, size_t chain);
+int         chainNext         (List* list, size_t idx, size_t chain);
+int         chainPrev         (List* list, size_t idx, size_t chain);
+
+bool        enableHashIndex   (List* list);
+void        disableHashIndex  (List* list);
+
+bool        enableRankIndex   (List* list);
+void        disableRankIndex  (List* list);
+int         insertAtPos       (List* list, list_elem_t value, size_t pos);
+list_elem_t removeAtPos       (List* list, size_t pos);
+list_elem_t atPos             (List* list, size_t pos);
+
+bool        beginBatch        (List* list, size_t maxInserts);
+void        commitBatch       (List* list);
+void        abortBatch        (List* list);
+
+ListSnapshot* snapshotList      (List* list);
+void          releaseSnapshot   (ListSnapshot* snapshot);
+size_t        getSnapshotVersion(ListSnapshot* snapshot);
+size_t        getSnapshotSize   (ListSnapshot* snapshot);
+list_elem_t   snapshotAt        (ListSnapshot* snapshot, size_t idx);
+int           snapshotNext      (ListSnapshot* snapshot, size_t idx);
+int           snapshotPrev      (ListSnapshot* snapshot, size_t idx);
+bool          snapshotFind      (ListSnapshot* snapshot, list_elem_t value, int* idx, int* pos);
+
+bool          enableConcurrentReads(List* list, size_t maxReaders);
+bool          beginRead         (List* list, ListReader* reader);
+void          endRead           (ListReader* reader);
+list_elem_t   readerAt          (ListReader* reader, size_t idx);
+int           readerNext        (ListReader* reader, size_t idx);
+bool          readerFind        (ListReader* reader, list_elem_t value, int* idx);
+void          reclaimRetired    (List* list);
+
+#ifdef LIST_SHARED_MEMORY_ENABLED
+List*       openSharedList    (List* list, const char* name, size_t capacity);
+void        closeSharedList   (List* list);
+bool        unlinkSharedList  (const char* name);
+bool        lockSharedList    (List* list);
+void        unlockSharedList  (List* list);
+#endif
+
+#ifdef LIST_PROFILING_ENABLED
+const ListOpProfile* getProfile(List* list, ListProfiledOp op);
+void        resetProfile      (List* list);
+#endif
 
 bool        listOk         (List* list);
 void        dump           (List* list);
@@ -137,8 +400,16 @@ void        dump           (List* list);
 namespace LIST_SLOW
 {
 
-void switchToIndexSearch (List* list);
-int  findIndex           (List* list, size_t pos);
-int  findPos             (List* list, size_t idx);
+void   switchToIndexSearch (List* list);
+void   sortAndLinearize    (List* list, ListComparator less);
+int    findIndex           (List* list, size_t pos);
+int    findPos             (List* list, size_t idx);
+
+void   findIndexMany       (List* list, const size_t* positions, int* outIdx, size_t count);
+void   findPosMany         (List* list, const size_t* idxs, int* outPos, size_t count);
+size_t findMany            (List* list, const list_elem_t* values, int* outIdx, int* outPos, size_t count);
+void   walkMany            (ListWalk* walks, size_t count, size_t inFlight);
 
-}
\ No newline at end of file
+}
+
+#endif
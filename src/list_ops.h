@@ -0,0 +1,1055 @@
+#ifndef LIST_OPS_H
+#define LIST_OPS_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <iterator>
+#include <list>
+#include <utility>
+#include <vector>
+#include "list.h"
+
+//-----------------------------------------------------------------------------
+//! Interpreter of byte strings as sequences of list operations, shared by
+//! the property test driver (test.cpp) and the fuzzer (fuzz.cpp). Every
+//! operation is applied both to a List and to a std::list model, then the
+//! list is checked against the model.
+//-----------------------------------------------------------------------------
+
+#define LIST_OPS_CHECK(condition)                                                     \
+    if (!(condition))                                                                 \
+    {                                                                                 \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+        abort();                                                                      \
+    }
+
+static const size_t LIST_OPS_MAX_SIZE    = 128;
+static const size_t LIST_OPS_VALUES      = 16;
+static const size_t LIST_OPS_MAX_QUERIES = 8;
+
+enum ListOp
+{
+    LIST_OP_PUSH_BACK,
+    LIST_OP_PUSH_FRONT,
+    LIST_OP_INSERT_AFTER,
+    LIST_OP_INSERT_BEFORE,
+    LIST_OP_INSERT_AT_POS,
+    LIST_OP_REMOVE,
+    LIST_OP_REMOVE_AT_POS,
+    LIST_OP_POP_BACK,
+    LIST_OP_POP_FRONT,
+    LIST_OP_MOVE_AFTER,
+    LIST_OP_FIND,
+    LIST_OP_CLEAR,
+    LIST_OP_RESERVE,
+    LIST_OP_SWITCH_TO_INDEX_SEARCH,
+    LIST_OP_SORT,
+    LIST_OP_SORT_AND_LINEARIZE,
+    LIST_OP_HASH_INDEX,
+    LIST_OP_RANK_INDEX,
+    LIST_OP_ALLOCATION_POLICY,
+    LIST_OP_GROWTH_POLICY,
+    LIST_OP_TWO_ENDED_SEARCH,
+    LIST_OP_BATCH,
+    LIST_OP_INSERT_SORTED,
+    LIST_OP_BOUNDS,
+    LIST_OP_LOAD_SORTED,
+    LIST_OP_CLONE,
+    LIST_OP_GROW_LINEARIZED,
+    LIST_OP_FIND_MANY,
+    LIST_OP_HANDLES,
+    LIST_OP_CHAINS,
+    LIST_OP_SNAPSHOT,
+    LIST_OP_READERS,
+
+    LIST_OPS_COUNT
+};
+
+typedef std::list<list_elem_t> ListModel;
+
+//-----------------------------------------------------------------------------
+//! Handles passed to a list's remap callback during one rewrite of its 
+//! buffer, oldHandles[i] became newHandles[i].
+//-----------------------------------------------------------------------------
+struct ListOpsRemaps
+{
+    std::vector<ListHandle> oldHandles;
+    std::vector<ListHandle> newHandles;
+};
+
+struct ListOpsInput
+{
+    const uint8_t* data = NULL;
+    size_t         size = 0;
+    size_t         read = 0;
+};
+
+//-----------------------------------------------------------------------------
+//! @param [out] input
+//!
+//! @return next byte of input or 0 if it's over.
+//-----------------------------------------------------------------------------
+inline uint8_t listOpsByte(ListOpsInput* input)
+{
+    return input->read < input->size ? input->data[input->read++] : 0;
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] model
+//! @param [in] pos   from 1 to model's size
+//!
+//! @return iterator to the element at pos.
+//-----------------------------------------------------------------------------
+inline ListModel::iterator listOpsModelAt(ListModel* model, size_t pos)
+{
+    ListModel::iterator iterator = model->begin();
+    std::advance(iterator, pos - 1);
+
+    return iterator;
+}
+
+//-----------------------------------------------------------------------------
+//! Checks that list holds the same elements as model in the same order and
+//! that positions and indices of the elements agree with each other.
+//!
+//! @param [in] list
+//! @param [in] model
+//! @param [in] checkedPos   the only position to check or 0 to walk the
+//!                          whole list and check every position (O(n^2))
+//-----------------------------------------------------------------------------
+inline void listOpsCheck(List* list, ListModel* model, size_t checkedPos)
+{
+    LIST_OPS_CHECK(list->batch != NULL || listOk(list));
+    LIST_OPS_CHECK(list->size == model->size());
+    LIST_OPS_CHECK(list->size == 0 || (list->head != 0 && list->tail != 0));
+
+    if (checkedPos != 0)
+    {
+        if (checkedPos > model->size()) { return; }
+
+        int index = LIST_SLOW::findIndex(list, checkedPos);
+
+        LIST_OPS_CHECK(at(list, index) == *listOpsModelAt(model, checkedPos));
+        LIST_OPS_CHECK((size_t) LIST_SLOW::findPos(list, index) == checkedPos);
+
+        return;
+    }
+
+    size_t pos   = 1;
+    size_t index = chainNext(list, 0, 0);
+
+    for (list_elem_t value : *model)
+    {
+        LIST_OPS_CHECK(index != 0);
+        LIST_OPS_CHECK(at(list, index) == value);
+        LIST_OPS_CHECK((size_t) LIST_SLOW::findIndex(list, pos)   == index);
+        LIST_OPS_CHECK((size_t) LIST_SLOW::findPos  (list, index) == pos);
+
+        index = chainNext(list, index, 0);
+        pos++;
+    }
+
+    LIST_OPS_CHECK(index == 0);
+}
+
+//-----------------------------------------------------------------------------
+//! ListRemapCallback recording the remaps into ListOpsRemaps.
+//!
+//! @param [in]  oldHandle
+//! @param [in]  newHandle
+//! @param [out] context   ListOpsRemaps
+//-----------------------------------------------------------------------------
+inline void listOpsRemap(ListHandle oldHandle, ListHandle newHandle, void* context)
+{
+    ListOpsRemaps* remaps = (ListOpsRemaps*) context;
+
+    remaps->oldHandles.push_back(oldHandle);
+    remaps->newHandles.push_back(newHandle);
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] remaps
+//! @param [in] index   index of an element before the rewrite
+//!
+//! @return index of the element after the rewrite.
+//-----------------------------------------------------------------------------
+inline size_t listOpsRemappedIndex(ListOpsRemaps* remaps, size_t index)
+{
+    for (size_t i = 0; i < remaps->oldHandles.size(); i++)
+    {
+        if (remaps->oldHandles[i].index == index) { return remaps->newHandles[i].index; }
+    }
+
+    return index;
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] remaps
+//! @param [in] handle   handle valid before the rewrite
+//!
+//! @return handle to the same element after the rewrite.
+//-----------------------------------------------------------------------------
+inline ListHandle listOpsRemappedHandle(ListOpsRemaps* remaps, ListHandle handle)
+{
+    for (size_t i = 0; i < remaps->oldHandles.size(); i++)
+    {
+        if (remaps->oldHandles[i].index      == handle.index && 
+            remaps->oldHandles[i].generation == handle.generation) { return remaps->newHandles[i]; }
+    }
+
+    return handle;
+}
+
+//-----------------------------------------------------------------------------
+//! Checks the extra chains of list against their models, which hold indices
+//! of the elements in chains' order.
+//!
+//! @param [in] list
+//! @param [in] chains   chains[c] is the model of chain c
+//-----------------------------------------------------------------------------
+inline void listOpsCheckChains(List* list, std::vector<std::vector<size_t>>* chains)
+{
+    for (size_t chain = 0; chain < chains->size(); chain++)
+    {
+        std::vector<size_t>* chainModel = &(*chains)[chain];
+
+        LIST_OPS_CHECK(chainModel->size() == list->size);
+
+        size_t index = 0;
+        for (size_t modelIndex : *chainModel)
+        {
+            LIST_OPS_CHECK(chainPrev(list, modelIndex, chain) == (int) index);
+
+            index = chainNext(list, index, chain);
+            LIST_OPS_CHECK(index == modelIndex);
+        }
+
+        LIST_OPS_CHECK(chainNext(list, index, chain) == 0);
+        LIST_OPS_CHECK(chainPrev(list, 0, chain) == (int) index);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//! Checks that snapshot holds the same elements as model in the same order.
+//!
+//! @param [in] snapshot
+//! @param [in] model
+//! @param [in] value   looked up by snapshotFind
+//-----------------------------------------------------------------------------
+inline void listOpsCheckSnapshot(ListSnapshot* snapshot, ListModel* model, list_elem_t value)
+{
+    LIST_OPS_CHECK(getSnapshotSize(snapshot) == model->size());
+
+    size_t index = 0;
+    for (list_elem_t modelValue : *model)
+    {
+        size_t next = snapshotNext(snapshot, index);
+
+        LIST_OPS_CHECK(next != 0);
+        LIST_OPS_CHECK(snapshotPrev(snapshot, next) == (int) index);
+        LIST_OPS_CHECK(snapshotAt(snapshot, next) == modelValue);
+
+        index = next;
+    }
+
+    LIST_OPS_CHECK(snapshotNext(snapshot, index) == 0);
+    LIST_OPS_CHECK(snapshotPrev(snapshot, 0) == (int) index);
+
+    // outputs start non-zero, so that a miss must zero them like find does
+    int  foundIndex = -1;
+    int  foundPos   = -1;
+    bool found      = snapshotFind(snapshot, value, &foundIndex, &foundPos);
+
+    ListModel::iterator first = std::find(model->begin(), model->end(), value);
+
+    LIST_OPS_CHECK(found == (first != model->end()));
+
+    if (found)
+    {
+        LIST_OPS_CHECK((size_t) foundPos == (size_t) std::distance(model->begin(), first) + 1);
+        LIST_OPS_CHECK(snapshotAt(snapshot, foundIndex) == value);
+    }
+    else
+    {
+        LIST_OPS_CHECK(foundIndex == 0 && foundPos == 0);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//! Checks that a reader of list, which isn't being changed, sees the same 
+//! elements as model in the same order.
+//!
+//! @param [in] reader
+//! @param [in] model
+//! @param [in] value   looked up by readerFind
+//-----------------------------------------------------------------------------
+inline void listOpsCheckReader(ListReader* reader, ListModel* model, list_elem_t value)
+{
+    size_t index = 0;
+    for (list_elem_t modelValue : *model)
+    {
+        index = readerNext(reader, index);
+
+        LIST_OPS_CHECK(index != 0);
+        LIST_OPS_CHECK(readerAt(reader, index) == modelValue);
+    }
+
+    LIST_OPS_CHECK(readerNext(reader, index) == 0);
+
+    int  readerIndex = 0;
+    int  listIndex   = 0;
+    bool found       = readerFind(reader, value, &readerIndex);
+
+    LIST_OPS_CHECK(found == find(reader->list, value, &listIndex, NULL));
+    LIST_OPS_CHECK(!found || readerIndex == listIndex);
+}
+
+//-----------------------------------------------------------------------------
+//! Applies the operation read from input to list and model.
+//!
+//! @param [out] list
+//! @param [out] model
+//! @param [out] batchModel   model's copy at the start of list's batch
+//! @param [out] input
+//-----------------------------------------------------------------------------
+inline void listOpsStep(List* list, ListModel* model, ListModel* batchModel, ListOpsInput* input)
+{
+    uint8_t op   = listOpsByte(input) % LIST_OPS_COUNT;
+    size_t  size = model->size();
+
+    bool insertion = op <= LIST_OP_INSERT_AT_POS || op == LIST_OP_INSERT_SORTED;
+    bool removal   = op >= LIST_OP_REMOVE && op <= LIST_OP_POP_FRONT;
+
+    if (insertion && size >= LIST_OPS_MAX_SIZE) { return; }
+    if (removal   && size == 0)                 { return; }
+
+    // only insert/remove calls are allowed inside a batch, others end it
+    if (list->batch != NULL && !insertion && !removal && op != LIST_OP_BATCH)
+    {
+        commitBatch(list);
+    }
+
+    switch (op)
+    {
+        case LIST_OP_PUSH_BACK:
+        {
+            list_elem_t value = listOpsByte(input) % LIST_OPS_VALUES;
+
+            pushBack(list, value);
+            model->push_back(value);
+            break;
+        }
+
+        case LIST_OP_PUSH_FRONT:
+        {
+            list_elem_t value = listOpsByte(input) % LIST_OPS_VALUES;
+
+            pushFront(list, value);
+            model->push_front(value);
+            break;
+        }
+
+        case LIST_OP_INSERT_AFTER:
+        {
+            size_t      pos   = listOpsByte(input) % (size + 1);
+            list_elem_t value = listOpsByte(input) % LIST_OPS_VALUES;
+
+            int index = insertAfter(list, value, pos > 0 ? LIST_SLOW::findIndex(list, pos) : 0);
+            model->insert(pos > 0 ? std::next(listOpsModelAt(model, pos)) : model->begin(), value);
+
+            LIST_OPS_CHECK(at(list, index) == value);
+            break;
+        }
+
+        case LIST_OP_INSERT_BEFORE:
+        {
+            if (size == 0) { break; }
+
+            size_t      pos   = listOpsByte(input) % size + 1;
+            list_elem_t value = listOpsByte(input) % LIST_OPS_VALUES;
+
+            insertBefore(list, value, LIST_SLOW::findIndex(list, pos));
+            model->insert(listOpsModelAt(model, pos), value);
+            break;
+        }
+
+        case LIST_OP_INSERT_AT_POS:
+        {
+            size_t      pos   = listOpsByte(input) % (size + 1) + 1;
+            list_elem_t value = listOpsByte(input) % LIST_OPS_VALUES;
+
+            insertAtPos(list, value, pos);
+            model->insert(pos <= size ? listOpsModelAt(model, pos) : model->end(), value);
+            break;
+        }
+
+        case LIST_OP_REMOVE:
+        {
+            size_t pos = listOpsByte(input) % size + 1;
+
+            ListModel::iterator removed = listOpsModelAt(model, pos);
+            size_t              index   = LIST_SLOW::findIndex(list, pos);
+
+            LIST_OPS_CHECK(remove(list, index) == *removed);
+
+            // the LIFO policy gives the slot back to the next inserted element
+            if (list->allocationPolicy == LIST_ALLOCATION_LIFO)
+            {
+                size_t prev = pos > 1 ? LIST_SLOW::findIndex(list, pos - 1) : 0;
+
+                LIST_OPS_CHECK((size_t) insertAfter(list, *removed, prev) == index);
+                remove(list, index);
+            }
+
+            model->erase(removed);
+            break;
+        }
+
+        case LIST_OP_REMOVE_AT_POS:
+        {
+            size_t pos = listOpsByte(input) % size + 1;
+
+            ListModel::iterator removed = listOpsModelAt(model, pos);
+
+            LIST_OPS_CHECK(removeAtPos(list, pos) == *removed);
+            model->erase(removed);
+            break;
+        }
+
+        case LIST_OP_POP_BACK:
+        {
+            LIST_OPS_CHECK(popBack(list) == model->back());
+            model->pop_back();
+            break;
+        }
+
+        case LIST_OP_POP_FRONT:
+        {
+            LIST_OPS_CHECK(popFront(list) == model->front());
+            model->pop_front();
+            break;
+        }
+
+        case LIST_OP_MOVE_AFTER:
+        {
+            if (size == 0) { break; }
+
+            size_t pos   = listOpsByte(input) % size + 1;
+            size_t after = listOpsByte(input) % (size + 1);
+
+            if (after == pos) { break; }
+
+            moveAfter(list, LIST_SLOW::findIndex(list, pos), after > 0 ? LIST_SLOW::findIndex(list, after) : 0);
+
+            ListModel::iterator moved       = listOpsModelAt(model, pos);
+            ListModel::iterator destination = after > 0 ? std::next(listOpsModelAt(model, after)) : model->begin();
+
+            model->splice(destination, *model, moved);
+            break;
+        }
+
+        case LIST_OP_FIND:
+        {
+            list_elem_t value = listOpsByte(input) % LIST_OPS_VALUES;
+
+            int  index = 0;
+            int  pos   = 0;
+            bool found = find(list, value, &index, &pos);
+
+            ListModel::iterator first = std::find(model->begin(), model->end(), value);
+
+            LIST_OPS_CHECK(found == (first != model->end()));
+
+            if (found)
+            {
+                LIST_OPS_CHECK((size_t) pos == (size_t) std::distance(model->begin(), first) + 1);
+                LIST_OPS_CHECK(at(list, index) == value);
+            }
+
+            break;
+        }
+
+        case LIST_OP_CLEAR:
+        {
+            // clearing too often would keep the list short
+            if (listOpsByte(input) % 8 != 0) { break; }
+
+            clear(list);
+            model->clear();
+            break;
+        }
+
+        case LIST_OP_RESERVE:
+        {
+            // pre-sizing must neither move elements nor re-enable index search
+            bool searchEnabled = list->searchEnabled;
+            LIST_OPS_CHECK(reserve(list, size + listOpsByte(input)));
+            LIST_OPS_CHECK(list->searchEnabled == searchEnabled);
+            break;
+        }
+
+        case LIST_OP_SWITCH_TO_INDEX_SEARCH:
+        {
+            LIST_SLOW::switchToIndexSearch(list);
+            LIST_OPS_CHECK(!list->searchEnabled);
+            break;
+        }
+
+        case LIST_OP_SORT:
+        {
+            sortList(list, NULL);
+            model->sort();
+            break;
+        }
+
+        case LIST_OP_SORT_AND_LINEARIZE:
+        {
+            LIST_SLOW::sortAndLinearize(list, NULL);
+            model->sort();
+            break;
+        }
+
+        case LIST_OP_HASH_INDEX:
+        {
+            if (list->hashTable == NULL) { LIST_OPS_CHECK(enableHashIndex(list)); }
+            else                         { disableHashIndex(list);                }
+            break;
+        }
+
+        case LIST_OP_RANK_INDEX:
+        {
+            if (list->rankNodes == NULL) { LIST_OPS_CHECK(enableRankIndex(list)); }
+            else                         { disableRankIndex(list);                }
+            break;
+        }
+
+        case LIST_OP_ALLOCATION_POLICY:
+        {
+            setAllocationPolicy(list, (ListAllocationPolicy) (listOpsByte(input) % 3));
+            break;
+        }
+
+        case LIST_OP_GROWTH_POLICY:
+        {
+            // huge page alignment makes the buffer 2MB, which debug checks
+            // walk entirely, so it's left out
+            uint8_t policy = listOpsByte(input) % LIST_GROWTH_HUGE_PAGE_ALIGNED;
+
+            setGrowthPolicy(list, (ListGrowthPolicy) policy, policy == LIST_GROWTH_FIXED_STEP ? 5 : 1.5);
+            break;
+        }
+
+        case LIST_OP_TWO_ENDED_SEARCH:
+        {
+            setTwoEndedSearch(list, !list->twoEndedSearch);
+            break;
+        }
+
+        case LIST_OP_BATCH:
+        {
+            if (list->batch == NULL)
+            {
+                LIST_OPS_CHECK(beginBatch(list, listOpsByte(input) % 16));
+                *batchModel = *model;
+            }
+            else if (listOpsByte(input) % 2 == 0)
+            {
+                commitBatch(list);
+            }
+            else
+            {
+                abortBatch(list);
+                *model = *batchModel;
+            }
+
+            break;
+        }
+
+        case LIST_OP_INSERT_SORTED:
+        {
+            if (!std::is_sorted(model->begin(), model->end())) { break; }
+
+            list_elem_t value = listOpsByte(input) % LIST_OPS_VALUES;
+
+            int index = insertSorted(list, value);
+            model->insert(std::upper_bound(model->begin(), model->end(), value), value);
+
+            LIST_OPS_CHECK(at(list, index) == value);
+            break;
+        }
+
+        case LIST_OP_BOUNDS:
+        {
+            if (!std::is_sorted(model->begin(), model->end())) { break; }
+
+            list_elem_t value = listOpsByte(input) % LIST_OPS_VALUES;
+
+            size_t lower = std::distance(model->begin(), std::lower_bound(model->begin(), model->end(), value)) + 1;
+            size_t upper = std::distance(model->begin(), std::upper_bound(model->begin(), model->end(), value)) + 1;
+
+            int lowerIndex = lowerBound(list, value);
+            int upperIndex = upperBound(list, value);
+
+            LIST_OPS_CHECK(lower > size ? lowerIndex == 0 : LIST_SLOW::findPos(list, lowerIndex) == (int) lower);
+            LIST_OPS_CHECK(upper > size ? upperIndex == 0 : LIST_SLOW::findPos(list, upperIndex) == (int) upper);
+            break;
+        }
+
+        case LIST_OP_LOAD_SORTED:
+        {
+            if (!std::is_sorted(model->begin(), model->end())) { break; }
+
+            list_elem_t values[LIST_OPS_VALUES] = {};
+            size_t      count = std::min((size_t) listOpsByte(input) % LIST_OPS_VALUES, LIST_OPS_MAX_SIZE - size);
+            list_elem_t last  = size > 0 ? model->back() : 0;
+
+            for (size_t i = 0; i < count; i++)
+            {
+                last      = last + listOpsByte(input) % 2;
+                values[i] = last;
+            }
+
+            LIST_OPS_CHECK(loadSorted(list, values, count));
+            model->insert(model->end(), values, values + count);
+            break;
+        }
+
+        case LIST_OP_CLONE:
+        {
+            // the list is replaced by its clone, so that the clone is checked from now on
+            List clone;
+
+            if (listOpsByte(input) % 2 == 0) { LIST_OPS_CHECK(cloneList      (list, &clone) != NULL); }
+            else                             { LIST_OPS_CHECK(cloneLinearized(list, &clone) != NULL); }
+
+            *list = std::move(clone);
+            LIST_OPS_CHECK(clone.nodes == NULL);
+            break;
+        }
+
+        case LIST_OP_GROW_LINEARIZED:
+        {
+            // growing the buffer keeps indices, so it mustn't undo linearization
+            LIST_SLOW::switchToIndexSearch(list);
+
+            LIST_OPS_CHECK(reserve(list, list->capacity + listOpsByte(input) % 8));
+            LIST_OPS_CHECK(!list->searchEnabled);
+
+            size_t free  = list->capacity - 1 - list->size;
+            size_t count = std::min(free + 1 + listOpsByte(input) % 4, LIST_OPS_MAX_SIZE - size);
+
+            if (std::is_sorted(model->begin(), model->end()))
+            {
+                list_elem_t values[LIST_OPS_MAX_SIZE] = {};
+                list_elem_t last = size > 0 ? model->back() : 0;
+
+                for (size_t i = 0; i < count; i++)
+                {
+                    last      = last + listOpsByte(input) % 2;
+                    values[i] = last;
+                }
+
+                LIST_OPS_CHECK(loadSorted(list, values, count));
+                model->insert(model->end(), values, values + count);
+            }
+            else
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    list_elem_t value = listOpsByte(input) % LIST_OPS_VALUES;
+
+                    pushBack(list, value);
+                    model->push_back(value);
+                }
+            }
+
+            LIST_OPS_CHECK(!list->searchEnabled);
+            break;
+        }
+
+        case LIST_OP_FIND_MANY:
+        {
+            // batched queries must answer exactly what one by one ones do
+            size_t      count = listOpsByte(input) % (LIST_OPS_MAX_QUERIES + 1);
+            list_elem_t values[LIST_OPS_MAX_QUERIES] = {};
+            int         outIdx[LIST_OPS_MAX_QUERIES] = {};
+            int         outPos[LIST_OPS_MAX_QUERIES] = {};
+
+            for (size_t i = 0; i < count; i++)
+            {
+                values[i] = listOpsByte(input) % LIST_OPS_VALUES;
+            }
+
+            size_t found = LIST_SLOW::findMany(list, values, outIdx, outPos, count);
+            size_t foundOneByOne = 0;
+
+            ListWalk walks[2 * LIST_OPS_MAX_QUERIES] = {};
+
+            for (size_t i = 0; i < count; i++)
+            {
+                int index = 0;
+                int pos   = 0;
+
+                foundOneByOne += find(list, values[i], &index, &pos);
+
+                LIST_OPS_CHECK(outIdx[i] == index);
+                LIST_OPS_CHECK(outPos[i] == pos);
+
+                walks[i].list  = list;
+                walks[i].kind  = LIST_WALK_FIND;
+                walks[i].value = values[i];
+            }
+
+            LIST_OPS_CHECK(found == foundOneByOne);
+
+            size_t walksCount = count;
+
+            if (size > 0)
+            {
+                size_t positions[LIST_OPS_MAX_QUERIES] = {};
+                size_t idxs     [LIST_OPS_MAX_QUERIES] = {};
+
+                for (size_t i = 0; i < count; i++)
+                {
+                    positions[i] = listOpsByte(input) % size + 1;
+                }
+
+                std::sort(positions, positions + count);
+
+                LIST_SLOW::findIndexMany(list, positions, outIdx, count);
+
+                for (size_t i = 0; i < count; i++)
+                {
+                    LIST_OPS_CHECK(outIdx[i] == LIST_SLOW::findIndex(list, positions[i]));
+
+                    // findPosMany takes indices in any order
+                    idxs[count - 1 - i] = outIdx[i];
+
+                    walks[walksCount].list = list;
+                    walks[walksCount].kind = LIST_WALK_FIND_INDEX;
+                    walks[walksCount].pos  = positions[i];
+                    walksCount++;
+                }
+
+                LIST_SLOW::findPosMany(list, idxs, outPos, count);
+
+                for (size_t i = 0; i < count; i++)
+                {
+                    LIST_OPS_CHECK(outPos[i] == LIST_SLOW::findPos(list, idxs[i]));
+                }
+            }
+
+            LIST_SLOW::walkMany(walks, walksCount, listOpsByte(input) % 4 + 1);
+
+            for (size_t i = 0; i < walksCount; i++)
+            {
+                if (walks[i].kind == LIST_WALK_FIND)
+                {
+                    int index = 0;
+                    int pos   = 0;
+                    find(list, walks[i].value, &index, &pos);
+
+                    LIST_OPS_CHECK(walks[i].idx == index);
+                    LIST_OPS_CHECK(walks[i].pos == (size_t) pos);
+                }
+                else
+                {
+                    LIST_OPS_CHECK(walks[i].idx == LIST_SLOW::findIndex(list, walks[i].pos));
+                }
+            }
+
+            break;
+        }
+
+        case LIST_OP_HANDLES:
+        {
+            // a handle must survive removal of other elements, reuse of 
+            // slots and linearization (through the remap callback), and a
+            // handle to a removed element must stay stale after its slot 
+            // is reused
+            if (size == 0) { break; }
+
+            LIST_OPS_CHECK(enableGenerations(list));
+
+            size_t kept        = listOpsByte(input) % size + 1;
+            size_t removed     = listOpsByte(input) % size + 1;
+            list_elem_t value  = listOpsByte(input) % LIST_OPS_VALUES;
+
+            ListHandle  keptHandle    = getHandle(list, LIST_SLOW::findIndex(list, kept));
+            ListHandle  removedHandle = getHandle(list, LIST_SLOW::findIndex(list, removed));
+            list_elem_t keptValue     = *listOpsModelAt(model, kept);
+            list_elem_t removedValue  = 0;
+
+            LIST_OPS_CHECK(removeHandle(list, removedHandle, &removedValue));
+            LIST_OPS_CHECK(removedValue == *listOpsModelAt(model, removed));
+            model->erase(listOpsModelAt(model, removed));
+
+            LIST_OPS_CHECK(!isHandleValid(list, removedHandle));
+            LIST_OPS_CHECK(isHandleValid(list, keptHandle) == (kept != removed));
+
+            ListHandle inserted = insertAfterHandle(list, value, kept != removed ? keptHandle : removedHandle);
+
+            if (kept != removed)
+            {
+                size_t keptNow = kept > removed ? kept - 1 : kept;
+                model->insert(std::next(listOpsModelAt(model, keptNow)), value);
+            }
+            else
+            {
+                LIST_OPS_CHECK(inserted.index == 0);
+
+                inserted = insertAfterHandle(list, value, ListHandle());
+                model->push_front(value);
+            }
+
+            LIST_OPS_CHECK(!isHandleValid(list, removedHandle));
+            LIST_OPS_CHECK(!removeHandle(list, removedHandle, NULL));
+
+            ListOpsRemaps remaps = {};
+            setRemapCallback(list, listOpsRemap, &remaps);
+            LIST_SLOW::switchToIndexSearch(list);
+            setRemapCallback(list, NULL, NULL);
+
+            keptHandle = listOpsRemappedHandle(&remaps, keptHandle);
+            inserted   = listOpsRemappedHandle(&remaps, inserted);
+
+            list_elem_t handleValue = 0;
+
+            LIST_OPS_CHECK(atHandle(list, inserted, &handleValue) && handleValue == value);
+            LIST_OPS_CHECK(kept == removed || (atHandle(list, keptHandle, &handleValue) && handleValue == keptValue));
+            break;
+        }
+
+        case LIST_OP_CHAINS:
+        {
+            // chains are never disabled and batches don't work with them, 
+            // so they are tested on a clone
+            List chained;
+            LIST_OPS_CHECK(cloneList(list, &chained) != NULL);
+
+            size_t chainsCount = listOpsByte(input) % 2 + 2;
+            LIST_OPS_CHECK(enableChains(&chained, chainsCount));
+
+            // extra chains start in list's order
+            std::vector<std::vector<size_t>> chains(chainsCount);
+            for (size_t index = chainNext(&chained, 0, 0); index != 0; index = chainNext(&chained, index, 0))
+            {
+                for (size_t chain = 0; chain < chainsCount; chain++) { chains[chain].push_back(index); }
+            }
+
+            listOpsCheckChains(&chained, &chains);
+
+            ListOpsRemaps remaps = {};
+            setRemapCallback(&chained, listOpsRemap, &remaps);
+
+            size_t steps = listOpsByte(input) % 8;
+            for (size_t step = 0; step < steps; step++)
+            {
+                size_t               chain      = listOpsByte(input) % chainsCount;
+                std::vector<size_t>* chainModel = &chains[chain];
+                size_t               chainSize  = chainModel->size();
+
+                switch (listOpsByte(input) % 4)
+                {
+                    case 0:
+                    {
+                        if (chainSize >= LIST_OPS_MAX_SIZE) { break; }
+
+                        size_t after = listOpsByte(input) % (chainSize + 1);
+                        size_t index = insertAfterChain(&chained, listOpsByte(input) % LIST_OPS_VALUES, 
+                                                        after > 0 ? (*chainModel)[after - 1] : 0, chain);
+                        LIST_OPS_CHECK(index != 0);
+
+                        for (size_t other = 0; other < chainsCount; other++)
+                        {
+                            if (other != chain) { chains[other].push_back(index); }
+                        }
+
+                        chainModel->insert(chainModel->begin() + after, index);
+                        break;
+                    }
+
+                    case 1:
+                    {
+                        if (chainSize == 0) { break; }
+
+                        size_t pos   = listOpsByte(input) % chainSize;
+                        size_t after = listOpsByte(input) % (chainSize + 1);
+                        size_t index = (*chainModel)[pos];
+
+                        if (after == pos + 1) { break; }
+
+                        moveAfterChain(&chained, index, after > 0 ? (*chainModel)[after - 1] : 0, chain);
+
+                        chainModel->erase(chainModel->begin() + pos);
+                        chainModel->insert(chainModel->begin() + (after > pos ? after - 1 : after), index);
+                        break;
+                    }
+
+                    case 2:
+                    {
+                        if (chainSize == 0) { break; }
+
+                        size_t index = (*chainModel)[listOpsByte(input) % chainSize];
+
+                        remove(&chained, index);
+
+                        for (std::vector<size_t>& other : chains)
+                        {
+                            other.erase(std::find(other.begin(), other.end(), index));
+                        }
+
+                        break;
+                    }
+
+                    case 3:
+                    {
+                        remaps = ListOpsRemaps();
+                        LIST_SLOW::switchToIndexSearch(&chained);
+
+                        for (std::vector<size_t>& other : chains)
+                        {
+                            for (size_t& index : other) { index = listOpsRemappedIndex(&remaps, index); }
+                        }
+
+                        break;
+                    }
+                }
+
+                LIST_OPS_CHECK(listOk(&chained));
+            }
+
+            listOpsCheckChains(&chained, &chains);
+
+            // a linearized clone puts the element at position i of chain 0 to index i
+            List linearized;
+            LIST_OPS_CHECK(cloneLinearized(&chained, &linearized) != NULL);
+
+            std::vector<size_t> newIndices(chained.capacity);
+            for (size_t pos = 0; pos < chains[0].size(); pos++) { newIndices[chains[0][pos]] = pos + 1; }
+
+            for (std::vector<size_t>& other : chains)
+            {
+                for (size_t& index : other) { index = newIndices[index]; }
+            }
+
+            listOpsCheckChains(&linearized, &chains);
+
+            destructList(&linearized);
+            destructList(&chained);
+            break;
+        }
+
+        case LIST_OP_SNAPSHOT:
+        {
+            // a snapshot must keep the state it was taken in while the list 
+            // keeps changing, and one taken after the changes must see them
+            ListSnapshot* snapshot = snapshotList(list);
+            LIST_OPS_CHECK(snapshot != NULL);
+
+            ListModel snapshotModel = *model;
+
+            size_t steps = listOpsByte(input) % 4;
+            for (size_t step = 0; step < steps; step++)
+            {
+                listOpsStep(list, model, batchModel, input);
+            }
+
+            if (list->batch != NULL) { commitBatch(list); }
+
+            ListSnapshot* later = snapshotList(list);
+            LIST_OPS_CHECK(later != NULL);
+
+            listOpsCheckSnapshot(snapshot, &snapshotModel, listOpsByte(input) % LIST_OPS_VALUES);
+            listOpsCheckSnapshot(later,    model,          listOpsByte(input) % LIST_OPS_VALUES);
+
+            releaseSnapshot(snapshot);
+            releaseSnapshot(later);
+            break;
+        }
+
+        case LIST_OP_READERS:
+        {
+            // a read section keeps its buffer readable while the list 
+            // grows and linearization retires the buffer
+            LIST_OPS_CHECK(enableConcurrentReads(list, 2));
+
+            ListReader reader = {};
+            LIST_OPS_CHECK(beginRead(list, &reader));
+
+            listOpsCheckReader(&reader, model, listOpsByte(input) % LIST_OPS_VALUES);
+
+            int head = readerNext(&reader, 0);
+
+            // the list mustn't be destructed or replaced during the section, 
+            // so it only gets elements appended, which can grow the buffer
+            size_t count = std::min((size_t) listOpsByte(input) % 8, LIST_OPS_MAX_SIZE - size);
+            for (size_t i = 0; i < count; i++)
+            {
+                list_elem_t value = listOpsByte(input) % LIST_OPS_VALUES;
+
+                pushBack(list, value);
+                model->push_back(value);
+            }
+
+            LIST_SLOW::switchToIndexSearch(list);
+
+            // the reader isn't consistent anymore, but must read allocated 
+            // memory and start from the head its section started with
+            LIST_OPS_CHECK(readerNext(&reader, 0) == head);
+
+            int index = 0;
+            readerFind(&reader, listOpsByte(input) % LIST_OPS_VALUES, &index);
+
+            endRead(&reader);
+            reclaimRetired(list);
+
+            LIST_OPS_CHECK(beginRead(list, &reader));
+            listOpsCheckReader(&reader, model, listOpsByte(input) % LIST_OPS_VALUES);
+            endRead(&reader);
+            break;
+        }
+
+        default:
+        {
+            break;
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//! Runs the operations encoded by data on a new list, checking it against
+//! the model after every one of them and fully at the end. Aborts on the
+//! first mismatch.
+//!
+//! @param [in] data
+//! @param [in] size
+//-----------------------------------------------------------------------------
+inline void runListOps(const uint8_t* data, size_t size)
+{
+    ListOpsInput input = {};
+    input.data = data;
+    input.size = size;
+
+    List list = {};
+    LIST_OPS_CHECK(constructList(&list, listOpsByte(&input) % 8 + 1) != NULL);
+
+    ListModel model      = {};
+    ListModel batchModel = {};
+
+    while (input.read < input.size)
+    {
+        listOpsStep(&list, &model, &batchModel, &input);
+        listOpsCheck(&list, &model, input.read % (model.size() + 1));
+    }
+
+    if (list.batch != NULL) { commitBatch(&list); }
+
+    listOpsCheck(&list, &model, 0);
+
+    destructList(&list);
+}
+
+#endif
@@ -0,0 +1,295 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <new>
+#include "sharded_list.h"
+
+bool listShardReserveStamps(ListShard* shard);
+void listMergeSiftDown     (ShardedListIterator* iterator, size_t heapPos, ShardedListCursor cursor);
+
+//-----------------------------------------------------------------------------
+//! ShardedList's constructor.
+//!
+//! @param [out] list
+//! @param [in]  shardsCount     number of shards, usually the number of
+//!              threads appending to the list (at most SHARDED_LIST_MAX_SHARDS)
+//! @param [in]  shardCapacity   starting capacity of every shard
+//!
+//! @return list if constructed successfully or NULL otherwise.
+//-----------------------------------------------------------------------------
+ShardedList* constructShardedList(ShardedList* list, size_t shardsCount, size_t shardCapacity)
+{
+    assert(list != NULL);
+    assert(shardsCount > 0 && shardsCount <= SHARDED_LIST_MAX_SHARDS);
+    assert(shardCapacity > 0);
+
+    list->shards = new (std::nothrow) ListShard[shardsCount];
+    if (list->shards == NULL) { return NULL; }
+
+    list->shardsCount = shardsCount;
+    list->sequence.store(0, std::memory_order_relaxed);
+
+    for (size_t i = 0; i < shardsCount; i++)
+    {
+        ListShard* shard = &list->shards[i];
+
+        if (constructList(&shard->list, shardCapacity) == NULL || !listShardReserveStamps(shard))
+        {
+            destructShardedList(list);
+            return NULL;
+        }
+    }
+
+    return list;
+}
+
+//-----------------------------------------------------------------------------
+//! ShardedList's destructor.
+//!
+//! @param [out] list
+//-----------------------------------------------------------------------------
+void destructShardedList(ShardedList* list)
+{
+    assert(list != NULL);
+
+    if (list->shards != NULL)
+    {
+        for (size_t i = 0; i < list->shardsCount; i++)
+        {
+            if (list->shards[i].list.nodes != NULL) { destructList(&list->shards[i].list); }
+            free(list->shards[i].stamps);
+        }
+
+        delete[] list->shards;
+    }
+
+    list->shards      = NULL;
+    list->shardsCount = 0;
+}
+
+//-----------------------------------------------------------------------------
+//! Appends value to the back of shard and stamps it with the next global
+//! sequence number.
+//!
+//! @param [out] list
+//! @param [in]  shard
+//! @param [in]  value
+//!
+//! @warning Every shard must be appended to by one thread at a time.
+//!          Different shards can be appended to concurrently.
+//!
+//! @return index of value inside shard's list or 0 if it couldn't be appended.
+//-----------------------------------------------------------------------------
+int shardedPushBack(ShardedList* list, size_t shard, list_elem_t value)
+{
+    assert(list != NULL);
+    assert(shard < list->shardsCount);
+
+    ListShard* listShard = &list->shards[shard];
+    uint64_t   stamp     = list->sequence.fetch_add(1, std::memory_order_relaxed);
+
+    int index = pushBack(&listShard->list, value);
+    if (index == 0) { return 0; }
+
+    if (!listShardReserveStamps(listShard))
+    {
+        remove(&listShard->list, index);
+        return 0;
+    }
+
+    listShard->stamps[index] = stamp;
+
+    return index;
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] list
+//!
+//! @return number of elements in all the shards.
+//!
+//! @warning Not synchronized with appends.
+//-----------------------------------------------------------------------------
+size_t getShardedSize(ShardedList* list)
+{
+    assert(list != NULL);
+
+    size_t size = 0;
+    for (size_t i = 0; i < list->shardsCount; i++)
+    {
+        size += list->shards[i].list.size;
+    }
+
+    return size;
+}
+
+//-----------------------------------------------------------------------------
+//! Empties all the shards and restarts the sequence.
+//!
+//! @param [out] list
+//!
+//! @warning Must not run concurrently with appends.
+//-----------------------------------------------------------------------------
+void clearSharded(ShardedList* list)
+{
+    assert(list != NULL);
+
+    for (size_t i = 0; i < list->shardsCount; i++)
+    {
+        clear(&list->shards[i].list);
+    }
+
+    list->sequence.store(0, std::memory_order_relaxed);
+}
+
+//-----------------------------------------------------------------------------
+//! Starts merged iteration over list's elements.
+//!
+//! @param [in]  list
+//! @param [out] iterator
+//!
+//! @warning Appends made after beginMerge may or may not be seen, so the list
+//!          shouldn't be appended to until the iteration is over.
+//-----------------------------------------------------------------------------
+void beginMerge(ShardedList* list, ShardedListIterator* iterator)
+{
+    assert(list != NULL);
+    assert(iterator != NULL);
+
+    iterator->list     = list;
+    iterator->heapSize = 0;
+
+    for (size_t i = 0; i < list->shardsCount; i++)
+    {
+        int index = list->shards[i].list.head;
+        iterator->indices[i] = index;
+
+        if (index != 0) { iterator->heap[iterator->heapSize++] = {list->shards[i].stamps[index], i}; }
+    }
+
+    for (size_t i = iterator->heapSize / 2; i > 0; i--)
+    {
+        listMergeSiftDown(iterator, i - 1, iterator->heap[i - 1]);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//! Takes the next element in global order. Every shard is already ordered by
+//! stamps, so the next element is the current one of the shard on top of 
+//! the heap. Then the shard sinks by its new current element's stamp or 
+//! leaves the heap if it has run out of elements.
+//!
+//! @param [out] iterator
+//! @param [out] value   (can be NULL)
+//! @param [out] stamp   sequence number of the element (can be NULL)
+//!
+//! @return whether or not there was an element left.
+//-----------------------------------------------------------------------------
+bool mergeNext(ShardedListIterator* iterator, list_elem_t* value, uint64_t* stamp)
+{
+    assert(iterator != NULL);
+    assert(iterator->list != NULL);
+
+    if (iterator->heapSize == 0) { return false; }
+
+    ShardedListCursor cursor = iterator->heap[0];
+    ListShard*        shard  = &iterator->list->shards[cursor.shard];
+    int               index  = iterator->indices[cursor.shard];
+
+    if (value != NULL) { *value = at(&shard->list, index); }
+    if (stamp != NULL) { *stamp = cursor.stamp; }
+
+    index = chainNext(&shard->list, index, 0);
+    iterator->indices[cursor.shard] = index;
+
+    if (index != 0) { cursor.stamp = shard->stamps[index];                 }
+    else            { cursor       = iterator->heap[--iterator->heapSize]; }
+
+    listMergeSiftDown(iterator, 0, cursor);
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//! Appends all list's elements in global order to the back of out and
+//! linearizes out, so that its LIST_SLOW::findIndex and LIST_SLOW::findPos
+//! work in O(1).
+//!
+//! @param [in]  list
+//! @param [out] out   constructed list
+//!
+//! @warning Must not run concurrently with appends.
+//!
+//! @return whether or not out could hold all the elements.
+//-----------------------------------------------------------------------------
+bool consolidate(ShardedList* list, List* out)
+{
+    assert(list != NULL);
+    assert(out  != NULL);
+
+    if (!reserve(out, out->size + getShardedSize(list))) { return false; }
+
+    ShardedListIterator iterator = {};
+    beginMerge(list, &iterator);
+
+    list_elem_t value = 0;
+    while (mergeNext(&iterator, &value, NULL))
+    {
+        pushBack(out, value);
+    }
+
+    LIST_SLOW::switchToIndexSearch(out);
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//! Makes shard's stamps array as big as its list's buffer.
+//!
+//! @param [out] shard
+//!
+//! @return whether or not the stamps array is big enough.
+//-----------------------------------------------------------------------------
+bool listShardReserveStamps(ListShard* shard)
+{
+    assert(shard != NULL);
+
+    if (shard->stampsCapacity >= shard->list.capacity) { return true; }
+
+    uint64_t* stamps = (uint64_t*) realloc(shard->stamps, shard->list.capacity * sizeof(uint64_t));
+    if (stamps == NULL) { return false; }
+
+    shard->stamps         = stamps;
+    shard->stampsCapacity = shard->list.capacity;
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//! Puts cursor to heapPos of iterator's heap and moves it down until its 
+//! stamp is less than the ones of its children. The cursor is passed by 
+//! value rather than stored first, so that reading it back doesn't wait 
+//! for the store.
+//!
+//! @param [out] iterator
+//! @param [in]  heapPos
+//! @param [in]  cursor
+//-----------------------------------------------------------------------------
+void listMergeSiftDown(ShardedListIterator* iterator, size_t heapPos, ShardedListCursor cursor)
+{
+    assert(iterator != NULL);
+
+    ShardedListCursor* heap = iterator->heap;
+
+    while (2 * heapPos + 1 < iterator->heapSize)
+    {
+        size_t child = 2 * heapPos + 1;
+
+        if (child + 1 < iterator->heapSize && heap[child + 1].stamp < heap[child].stamp) { child++; }
+
+        if (cursor.stamp < heap[child].stamp) { break; }
+
+        heap[heapPos] = heap[child];
+        heapPos       = child;
+    }
+
+    heap[heapPos] = cursor;
+}
@@ -0,0 +1,68 @@
+#ifndef SHARDED_LIST_H
+#define SHARDED_LIST_H
+
+#include <stdint.h>
+#include <atomic>
+#include "list.h"
+
+static const size_t SHARDED_LIST_MAX_SHARDS = 64;
+
+//-----------------------------------------------------------------------------
+//! One shard of a ShardedList: a list of its own with the global sequence
+//! number of every element stored next to it (stamps[idx] belongs to the
+//! element at idx). Aligned so that writers of neighbouring shards don't
+//! share cache lines.
+//-----------------------------------------------------------------------------
+struct alignas(LIST_NODES_ALIGNMENT) ListShard
+{
+    List      list           = {};
+    uint64_t* stamps         = NULL;
+    size_t    stampsCapacity = 0;
+};
+
+//-----------------------------------------------------------------------------
+//! Append-only list split into shards, so that several threads can append
+//! at the same time, each one to its own shard. The only shared state is the
+//! sequence counter, which orders elements of all the shards globally.
+//-----------------------------------------------------------------------------
+struct ShardedList
+{
+    ListShard*            shards      = NULL;
+    size_t                shardsCount = 0;
+    std::atomic<uint64_t> sequence    = {0};
+};
+
+//-----------------------------------------------------------------------------
+//! Shard in ShardedListIterator's heap with the stamp of its current element.
+//-----------------------------------------------------------------------------
+struct ShardedListCursor
+{
+    uint64_t stamp = 0;
+    size_t   shard = 0;
+};
+
+//-----------------------------------------------------------------------------
+//! Walks elements of all the shards in the order they were appended in.
+//! Shards that have elements left are kept in a binary min-heap by the stamp
+//! of their current element, so taking an element costs O(log(shards)).
+//-----------------------------------------------------------------------------
+struct ShardedListIterator
+{
+    ShardedList*      list                             = NULL;
+    int               indices[SHARDED_LIST_MAX_SHARDS] = {};
+    ShardedListCursor heap   [SHARDED_LIST_MAX_SHARDS] = {};
+    size_t            heapSize                         = 0;
+};
+
+ShardedList* constructShardedList(ShardedList* list, size_t shardsCount, size_t shardCapacity);
+void         destructShardedList (ShardedList* list);
+
+int          shardedPushBack     (ShardedList* list, size_t shard, list_elem_t value);
+size_t       getShardedSize      (ShardedList* list);
+void         clearSharded        (ShardedList* list);
+
+void         beginMerge          (ShardedList* list, ShardedListIterator* iterator);
+bool         mergeNext           (ShardedListIterator* iterator, list_elem_t* value, uint64_t* stamp);
+bool         consolidate         (ShardedList* list, List* out);
+
+#endif
@@ -0,0 +1,167 @@
+#ifndef SHARDED_LIST_OPS_H
+#define SHARDED_LIST_OPS_H
+
+#include <stdint.h>
+#include <utility>
+#include <vector>
+#include "list_ops.h"
+#include "sharded_list.h"
+
+//-----------------------------------------------------------------------------
+//! Interpreter of byte strings as sequences of ShardedList operations,
+//! checked against a std::vector of values and their shards in the order
+//! they were appended in.
+//-----------------------------------------------------------------------------
+
+typedef std::vector<std::pair<list_elem_t, size_t>> ShardedListModel;
+
+enum ShardedListOp
+{
+    SHARDED_OP_PUSH_BACK,
+    SHARDED_OP_MERGE,
+    SHARDED_OP_CONSOLIDATE,
+    SHARDED_OP_CLEAR,
+
+    SHARDED_OPS_COUNT
+};
+
+//-----------------------------------------------------------------------------
+//! Checks that every shard of list holds the model's values appended to it
+//! in the same order.
+//!
+//! @param [in] list
+//! @param [in] model
+//-----------------------------------------------------------------------------
+inline void shardedOpsCheck(ShardedList* list, ShardedListModel* model)
+{
+    LIST_OPS_CHECK(getShardedSize(list) == model->size());
+
+    for (size_t shard = 0; shard < list->shardsCount; shard++)
+    {
+        List* shardList = &list->shards[shard].list;
+        int   index     = chainNext(shardList, 0, 0);
+
+        for (std::pair<list_elem_t, size_t>& element : *model)
+        {
+            if (element.second != shard) { continue; }
+
+            LIST_OPS_CHECK(index != 0);
+            LIST_OPS_CHECK(at(shardList, index) == element.first);
+
+            index = chainNext(shardList, index, 0);
+        }
+
+        LIST_OPS_CHECK(index == 0);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//! Applies the operation read from input to list and model.
+//!
+//! @param [out] list
+//! @param [out] model
+//! @param [out] input
+//-----------------------------------------------------------------------------
+inline void shardedOpsStep(ShardedList* list, ShardedListModel* model, ListOpsInput* input)
+{
+    uint8_t op = listOpsByte(input) % SHARDED_OPS_COUNT;
+
+    switch (op)
+    {
+        case SHARDED_OP_PUSH_BACK:
+        {
+            if (model->size() >= LIST_OPS_MAX_SIZE) { break; }
+
+            size_t      shard = listOpsByte(input) % list->shardsCount;
+            list_elem_t value = listOpsByte(input) % LIST_OPS_VALUES;
+
+            LIST_OPS_CHECK(shardedPushBack(list, shard, value) != 0);
+            model->emplace_back(value, shard);
+            break;
+        }
+
+        case SHARDED_OP_MERGE:
+        {
+            // merging must restore the global order with increasing stamps
+            ShardedListIterator iterator = {};
+            beginMerge(list, &iterator);
+
+            list_elem_t value = 0;
+            uint64_t    stamp = 0;
+
+            for (size_t i = 0; i < model->size(); i++)
+            {
+                uint64_t previous = stamp;
+
+                LIST_OPS_CHECK(mergeNext(&iterator, &value, &stamp));
+                LIST_OPS_CHECK(value == (*model)[i].first);
+                LIST_OPS_CHECK(i == 0 || stamp > previous);
+            }
+
+            LIST_OPS_CHECK(!mergeNext(&iterator, &value, &stamp));
+            break;
+        }
+
+        case SHARDED_OP_CONSOLIDATE:
+        {
+            List out = {};
+            LIST_OPS_CHECK(constructList(&out, listOpsByte(input) % 8 + 1) != NULL);
+
+            LIST_OPS_CHECK(consolidate(list, &out));
+            LIST_OPS_CHECK(out.size == model->size());
+            LIST_OPS_CHECK(!out.searchEnabled);
+
+            for (size_t i = 0; i < model->size(); i++)
+            {
+                LIST_OPS_CHECK(at(&out, LIST_SLOW::findIndex(&out, i + 1)) == (*model)[i].first);
+            }
+
+            destructList(&out);
+            break;
+        }
+
+        case SHARDED_OP_CLEAR:
+        {
+            // clearing too often would keep the list short
+            if (listOpsByte(input) % 8 != 0) { break; }
+
+            clearSharded(list);
+            model->clear();
+            break;
+        }
+
+        default:
+        {
+            break;
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//! Runs the operations encoded by data on a new sharded list, checking it
+//! against the model after every one of them. Aborts on the first mismatch.
+//!
+//! @param [in] data
+//! @param [in] size
+//-----------------------------------------------------------------------------
+inline void runShardedListOps(const uint8_t* data, size_t size)
+{
+    ListOpsInput input = {};
+    input.data = data;
+    input.size = size;
+
+    ShardedList list = {};
+    LIST_OPS_CHECK(constructShardedList(&list, listOpsByte(&input) % SHARDED_LIST_MAX_SHARDS + 1, listOpsByte(&input) % 4 + 1) != NULL);
+
+    ShardedListModel model = {};
+
+    while (input.read < input.size)
+    {
+        shardedOpsStep(&list, &model, &input);
+        shardedOpsCheck(&list, &model);
+    }
+
+    destructShardedList(&list);
+}
+
+#endif
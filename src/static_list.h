@@ -0,0 +1,260 @@
+#ifndef STATIC_LIST_H
+#define STATIC_LIST_H
+
+#include <stddef.h>
+#include <array>
+
+//-----------------------------------------------------------------------------
+//! Node of StaticIndexedList. Free slots that have been used have prev = -1.
+//-----------------------------------------------------------------------------
+template <typename T>
+struct StaticListNode
+{
+    T   value = T();
+    int prev  = 0;
+    int next  = 0;
+};
+
+//-----------------------------------------------------------------------------
+//! Indexed list of at most N elements with its nodes inside the object, so
+//! it never allocates and never grows. Indices and positions work the same
+//! way as List's ones (indexing starts from 1, 0 is the sentinel). All the
+//! operations are constexpr, so a list can be built at compile time.
+//!
+//! Slots at or above freeWatermark have never been used and are handed out
+//! one by one, freed slots are threaded through next starting from free.
+//! Therefore constructing or clearing a list doesn't touch its nodes.
+//-----------------------------------------------------------------------------
+template <typename T, size_t N>
+struct StaticIndexedList
+{
+    std::array<StaticListNode<T>, N + 1> nodes = {};
+
+    size_t size          = 0;
+    size_t head          = 0;
+    size_t tail          = 0;
+    size_t free          = 0;
+    size_t freeWatermark = 1;
+
+    constexpr size_t capacity() const { return N; }
+    constexpr bool   isEmpty () const { return size == 0; }
+    constexpr bool   isFull  () const { return size == N; }
+
+    constexpr bool   isUsed  (size_t idx) const;
+
+    constexpr int    insertAfter (const T& value, size_t idx);
+    constexpr int    insertBefore(const T& value, size_t idx);
+    constexpr T      at          (size_t idx) const;
+    constexpr T      remove      (size_t idx);
+    constexpr void   clear       ();
+
+    constexpr int    pushBack    (const T& value) { return insertAfter(value, tail); }
+    constexpr int    pushFront   (const T& value) { return insertAfter(value, 0);    }
+    constexpr T      popBack     ()               { return remove(tail);             }
+    constexpr T      popFront    ()               { return remove(head);             }
+
+    constexpr bool   find        (const T& value, int* idx, int* pos) const;
+    constexpr int    findIndex   (size_t pos) const;
+    constexpr int    findPos     (size_t idx) const;
+};
+
+//-----------------------------------------------------------------------------
+//! @param [in] idx
+//!
+//! @return whether or not there's an element at idx.
+//-----------------------------------------------------------------------------
+template <typename T, size_t N>
+constexpr bool StaticIndexedList<T, N>::isUsed(size_t idx) const
+{
+    return idx > 0 && idx < freeWatermark && nodes[idx].prev != -1;
+}
+
+//-----------------------------------------------------------------------------
+//! Inserts value after node with index idx (indexing starts from 1).
+//!
+//! @param [in] value
+//! @param [in] idx   0 inserts value at the front
+//!
+//! @return index at which value was inserted or 0 if the list is full.
+//-----------------------------------------------------------------------------
+template <typename T, size_t N>
+constexpr int StaticIndexedList<T, N>::insertAfter(const T& value, size_t idx)
+{
+    if (size == N)                 { return 0; }
+    if (idx != 0 && !isUsed(idx))  { return 0; }
+
+    size_t inserted = 0;
+
+    if (free != 0)
+    {
+        inserted = free;
+        free     = nodes[free].next;
+    }
+    else
+    {
+        inserted = freeWatermark++;
+    }
+
+    size_t next = idx != 0 ? nodes[idx].next : head;
+
+    nodes[inserted].value = value;
+    nodes[inserted].prev  = idx;
+    nodes[inserted].next  = next;
+
+    if (idx  != 0) { nodes[idx].next  = inserted; }
+    else           { head             = inserted; }
+
+    if (next != 0) { nodes[next].prev = inserted; }
+    else           { tail             = inserted; }
+
+    size++;
+
+    return inserted;
+}
+
+//-----------------------------------------------------------------------------
+//! Inserts value before node with index idx (indexing starts from 1).
+//!
+//! @param [in] value
+//! @param [in] idx
+//!
+//! @return index at which value was inserted or 0 if the list is full or idx
+//!         is 0.
+//-----------------------------------------------------------------------------
+template <typename T, size_t N>
+constexpr int StaticIndexedList<T, N>::insertBefore(const T& value, size_t idx)
+{
+    if (!isUsed(idx)) { return 0; }
+
+    return insertAfter(value, nodes[idx].prev);
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] idx
+//!
+//! @return element at idx or T() if there's none.
+//-----------------------------------------------------------------------------
+template <typename T, size_t N>
+constexpr T StaticIndexedList<T, N>::at(size_t idx) const
+{
+    if (!isUsed(idx)) { return T(); }
+
+    return nodes[idx].value;
+}
+
+//-----------------------------------------------------------------------------
+//! Removes element at idx (indexing starts from 1).
+//!
+//! @param [in] idx
+//!
+//! @return element removed or T() if there was none.
+//-----------------------------------------------------------------------------
+template <typename T, size_t N>
+constexpr T StaticIndexedList<T, N>::remove(size_t idx)
+{
+    if (!isUsed(idx)) { return T(); }
+
+    T      value = nodes[idx].value;
+    size_t prev  = nodes[idx].prev;
+    size_t next  = nodes[idx].next;
+
+    if (prev != 0) { nodes[prev].next = next; }
+    else           { head             = next; }
+
+    if (next != 0) { nodes[next].prev = prev; }
+    else           { tail             = prev; }
+
+    nodes[idx].prev = -1;
+    nodes[idx].next = free;
+    free            = idx;
+
+    size--;
+
+    return value;
+}
+
+//-----------------------------------------------------------------------------
+//! Empties the list in O(1).
+//-----------------------------------------------------------------------------
+template <typename T, size_t N>
+constexpr void StaticIndexedList<T, N>::clear()
+{
+    size          = 0;
+    head          = 0;
+    tail          = 0;
+    free          = 0;
+    freeWatermark = 1;
+}
+
+//-----------------------------------------------------------------------------
+//! Finds first occurrence of value.
+//!
+//! @param [in]  value
+//! @param [out] idx   index of the element found
+//! @param [out] pos   position of the element found (can be NULL)
+//!
+//! @return whether or not value has been found.
+//-----------------------------------------------------------------------------
+template <typename T, size_t N>
+constexpr bool StaticIndexedList<T, N>::find(const T& value, int* idx, int* pos) const
+{
+    size_t currentPos = 1;
+    for (size_t index = head; index != 0; index = nodes[index].next, currentPos++)
+    {
+        if (nodes[index].value == value)
+        {
+            *idx = index;
+            if (pos != NULL) { *pos = currentPos; }
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+//! Finds index of the element at pos, walking from the nearest end.
+//!
+//! @param [in] pos
+//!
+//! @return found index or 0 if pos is out of the list.
+//-----------------------------------------------------------------------------
+template <typename T, size_t N>
+constexpr int StaticIndexedList<T, N>::findIndex(size_t pos) const
+{
+    if (pos == 0 || pos > size) { return 0; }
+
+    size_t index = 0;
+
+    if (pos <= size - pos + 1)
+    {
+        index = head;
+        for (size_t i = 1; i < pos; i++) { index = nodes[index].next; }
+    }
+    else
+    {
+        index = tail;
+        for (size_t i = size; i > pos; i--) { index = nodes[index].prev; }
+    }
+
+    return index;
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] idx
+//!
+//! @return position of the element at idx or 0 if there's none.
+//-----------------------------------------------------------------------------
+template <typename T, size_t N>
+constexpr int StaticIndexedList<T, N>::findPos(size_t idx) const
+{
+    if (!isUsed(idx)) { return 0; }
+
+    size_t pos = 1;
+    for (size_t index = head; index != idx; index = nodes[index].next) { pos++; }
+
+    return pos;
+}
+
+#endif
@@ -0,0 +1,213 @@
+#ifndef STATIC_LIST_OPS_H
+#define STATIC_LIST_OPS_H
+
+#include <stdint.h>
+#include <vector>
+#include "list_ops.h"
+#include "static_list.h"
+
+//-----------------------------------------------------------------------------
+//! Interpreter of byte strings as sequences of StaticIndexedList operations,
+//! checked against a std::vector model like in list_ops.h. The list is small
+//! so that it gets full often.
+//-----------------------------------------------------------------------------
+
+static const size_t STATIC_OPS_CAPACITY = 24;
+
+typedef StaticIndexedList<list_elem_t, STATIC_OPS_CAPACITY> StaticOpsList;
+typedef std::vector<list_elem_t>                            StaticListModel;
+
+enum StaticListOp
+{
+    STATIC_OP_PUSH_BACK,
+    STATIC_OP_PUSH_FRONT,
+    STATIC_OP_INSERT_AFTER,
+    STATIC_OP_INSERT_BEFORE,
+    STATIC_OP_REMOVE,
+    STATIC_OP_POP_BACK,
+    STATIC_OP_POP_FRONT,
+    STATIC_OP_FIND,
+    STATIC_OP_CLEAR,
+
+    STATIC_OPS_COUNT
+};
+
+// the list works at compile time too
+static_assert([]() constexpr
+{
+    StaticIndexedList<int, 4> list;
+    list.pushBack(2);
+    list.pushFront(1);
+    list.insertAfter(3, list.tail);
+
+    return list.size == 3 && list.at(list.findIndex(2)) == 2 && list.popFront() == 1;
+}(), "StaticIndexedList doesn't work in constant expressions");
+
+//-----------------------------------------------------------------------------
+//! Checks that list holds the same elements as model in the same order.
+//!
+//! @param [in] list
+//! @param [in] model
+//-----------------------------------------------------------------------------
+inline void staticOpsCheck(StaticOpsList* list, StaticListModel* model)
+{
+    LIST_OPS_CHECK(list->size == model->size());
+    LIST_OPS_CHECK(list->isFull() == (model->size() == STATIC_OPS_CAPACITY));
+
+    size_t prev  = 0;
+    size_t index = list->head;
+    size_t pos   = 1;
+
+    for (list_elem_t value : *model)
+    {
+        LIST_OPS_CHECK(list->isUsed(index));
+        LIST_OPS_CHECK(list->at(index) == value);
+        LIST_OPS_CHECK((size_t) list->nodes[index].prev == prev);
+        LIST_OPS_CHECK((size_t) list->findIndex(pos) == index);
+        LIST_OPS_CHECK((size_t) list->findPos(index) == pos);
+
+        prev  = index;
+        index = list->nodes[index].next;
+        pos++;
+    }
+
+    LIST_OPS_CHECK(index == 0 && list->tail == prev);
+}
+
+//-----------------------------------------------------------------------------
+//! Applies the operation read from input to list and model.
+//!
+//! @param [out] list
+//! @param [out] model
+//! @param [out] input
+//-----------------------------------------------------------------------------
+inline void staticOpsStep(StaticOpsList* list, StaticListModel* model, ListOpsInput* input)
+{
+    uint8_t     op    = listOpsByte(input) % STATIC_OPS_COUNT;
+    size_t      size  = model->size();
+    bool        full  = size == STATIC_OPS_CAPACITY;
+    list_elem_t value = listOpsByte(input) % LIST_OPS_VALUES;
+
+    switch (op)
+    {
+        case STATIC_OP_PUSH_BACK:
+        {
+            int index = list->pushBack(value);
+
+            LIST_OPS_CHECK((index == 0) == full);
+            if (!full) { model->push_back(value); }
+            break;
+        }
+
+        case STATIC_OP_PUSH_FRONT:
+        {
+            int index = list->pushFront(value);
+
+            LIST_OPS_CHECK((index == 0) == full);
+            if (!full) { model->insert(model->begin(), value); }
+            break;
+        }
+
+        case STATIC_OP_INSERT_AFTER:
+        case STATIC_OP_INSERT_BEFORE:
+        {
+            if (size == 0) { break; }
+
+            bool   after = op == STATIC_OP_INSERT_AFTER;
+            size_t pos   = listOpsByte(input) % size + 1;
+            size_t index = list->findIndex(pos);
+
+            int inserted = after ? list->insertAfter(value, index) : list->insertBefore(value, index);
+
+            LIST_OPS_CHECK((inserted == 0) == full);
+            if (!full) { model->insert(model->begin() + (after ? pos : pos - 1), value); }
+            break;
+        }
+
+        case STATIC_OP_REMOVE:
+        {
+            if (size == 0) { break; }
+
+            size_t pos   = listOpsByte(input) % size + 1;
+            size_t index = list->findIndex(pos);
+
+            LIST_OPS_CHECK(list->remove(index) == (*model)[pos - 1]);
+            model->erase(model->begin() + (pos - 1));
+
+            // a freed slot holds no element anymore
+            LIST_OPS_CHECK(!list->isUsed(index) && list->remove(index) == list_elem_t());
+            break;
+        }
+
+        case STATIC_OP_POP_BACK:
+        {
+            if (size == 0) { break; }
+
+            LIST_OPS_CHECK(list->popBack() == model->back());
+            model->pop_back();
+            break;
+        }
+
+        case STATIC_OP_POP_FRONT:
+        {
+            if (size == 0) { break; }
+
+            LIST_OPS_CHECK(list->popFront() == model->front());
+            model->erase(model->begin());
+            break;
+        }
+
+        case STATIC_OP_FIND:
+        {
+            int  index = 0;
+            int  pos   = 0;
+            bool found = list->find(value, &index, &pos);
+
+            StaticListModel::iterator first = std::find(model->begin(), model->end(), value);
+
+            LIST_OPS_CHECK(found == (first != model->end()));
+            LIST_OPS_CHECK(!found || (size_t) pos == (size_t) (first - model->begin()) + 1);
+            break;
+        }
+
+        case STATIC_OP_CLEAR:
+        {
+            // clearing too often would keep the list short
+            if (value != 0) { break; }
+
+            list->clear();
+            model->clear();
+            break;
+        }
+
+        default:
+        {
+            break;
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//! Runs the operations encoded by data on a new static list, checking it
+//! against the model after every one of them. Aborts on the first mismatch.
+//!
+//! @param [in] data
+//! @param [in] size
+//-----------------------------------------------------------------------------
+inline void runStaticListOps(const uint8_t* data, size_t size)
+{
+    ListOpsInput input = {};
+    input.data = data;
+    input.size = size;
+
+    StaticOpsList   list  = {};
+    StaticListModel model = {};
+
+    while (input.read < input.size)
+    {
+        staticOpsStep(&list, &model, &input);
+        staticOpsCheck(&list, &model);
+    }
+}
+
+#endif
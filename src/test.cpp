@@ -0,0 +1,212 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "indexed_lru_ops.h"
+#include "list_ops.h"
+#include "sharded_list_ops.h"
+#include "static_list_ops.h"
+#include "unrolled_list_ops.h"
+#include "../libs/log_generator.h"
+
+const size_t   LIST_TEST_SEQUENCES     = 2000;
+const size_t   LIST_TEST_MAX_LENGTH    = 1024;
+const unsigned LIST_TEST_DEFAULT_SEED  = 2021;
+const size_t   LIST_TEST_GROWTH_PUSHES = 2000;
+
+//-----------------------------------------------------------------------------
+//! Runs the operations encoded by data through every container's 
+//! interpreter.
+//!
+//! @param [in] data
+//! @param [in] size
+//-----------------------------------------------------------------------------
+void runOps(const uint8_t* data, size_t size)
+{
+    runListOps        (data, size);
+    runUnrolledListOps(data, size);
+    runStaticListOps  (data, size);
+    runShardedListOps (data, size);
+    runLRUOps         (data, size);
+}
+
+//-----------------------------------------------------------------------------
+//! Runs the operations stored in file through runOps.
+//!
+//! @param [in] fileName
+//!
+//! @return whether or not the file has been read.
+//-----------------------------------------------------------------------------
+bool runFile(const char* fileName)
+{
+    FILE* file = fopen(fileName, "rb");
+    if (file == NULL) { return false; }
+
+    uint8_t* data = (uint8_t*) calloc(LIST_TEST_MAX_LENGTH, sizeof(uint8_t));
+    if (data == NULL)
+    {
+        fclose(file);
+        return false;
+    }
+
+    size_t size = fread(data, sizeof(uint8_t), LIST_TEST_MAX_LENGTH, file);
+    fclose(file);
+
+    runOps(data, size);
+
+    free(data);
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//! @param [out] list   
+//! @param [in]  count   
+//!
+//! @return number of times list's capacity changed while count elements 
+//!         were pushed to its back.
+//-----------------------------------------------------------------------------
+size_t countGrowths(List* list, size_t count)
+{
+    size_t growths  = 0;
+    size_t capacity = list->capacity;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        LIST_OPS_CHECK(pushBack(list, (list_elem_t) i) != 0);
+
+        if (list->capacity != capacity) { growths++; }
+        capacity = list->capacity;
+    }
+
+    return growths;
+}
+
+//-----------------------------------------------------------------------------
+//! Checks that a list created by newList gets the same defaults as one 
+//! constructed in place, so that it grows the same way.
+//-----------------------------------------------------------------------------
+void testNewList()
+{
+    List* heapList = newList();
+    LIST_OPS_CHECK(heapList != NULL);
+
+    LIST_OPS_CHECK(heapList->growthPolicy == LIST_GROWTH_GEOMETRIC);
+    LIST_OPS_CHECK(heapList->growthFactor == LIST_EXPAND_MULTIPLIER);
+    LIST_OPS_CHECK(heapList->chainsCount  == 1);
+
+    List stackList = {};
+    LIST_OPS_CHECK(constructList(&stackList, LIST_DEFAULT_CAPACITY) != NULL);
+
+    LIST_OPS_CHECK(heapList->capacity == stackList.capacity);
+    LIST_OPS_CHECK(countGrowths(heapList, LIST_TEST_GROWTH_PUSHES) == countGrowths(&stackList, LIST_TEST_GROWTH_PUSHES));
+
+    destructList(&stackList);
+    deleteList(heapList);
+
+    // the requested capacity is used too
+    heapList = newList(LIST_TEST_GROWTH_PUSHES);
+    LIST_OPS_CHECK(heapList != NULL);
+    LIST_OPS_CHECK(countGrowths(heapList, LIST_TEST_GROWTH_PUSHES) == 0);
+
+    deleteList(heapList);
+}
+
+//-----------------------------------------------------------------------------
+//! Checks that chains work on a list created by newList: elements inserted
+//! into one chain go to the tail of the other one and both orders survive 
+//! moves, removals and linearization.
+//-----------------------------------------------------------------------------
+void testNewListChains()
+{
+    List* list = newList();
+    LIST_OPS_CHECK(list != NULL);
+
+    // chain 0 is the list itself even before chains are enabled
+    LIST_OPS_CHECK(list->chainsCount == 1);
+    LIST_OPS_CHECK(chainNext(list, 0, 0) == 0 && chainPrev(list, 0, 0) == 0);
+
+    LIST_OPS_CHECK(enableChains(list, 2));
+
+    // chain 0 gets 1 2 3 4, chain 1 gets them in reverse
+    int indices[4] = {};
+    for (size_t i = 0; i < 4; i++)
+    {
+        indices[i] = insertAfterChain(list, (list_elem_t) (i + 1), i > 0 ? indices[i - 1] : 0, 0);
+        LIST_OPS_CHECK(indices[i] != 0);
+
+        moveAfterChain(list, indices[i], 0, 1);
+    }
+
+    for (size_t pass = 0; pass < 2; pass++)
+    {
+        int forward  = chainNext(list, 0, 0);
+        int backward = chainNext(list, 0, 1);
+
+        for (size_t i = 0; i < 4; i++)
+        {
+            LIST_OPS_CHECK(at(list, forward)  == (list_elem_t) (i + 1));
+            LIST_OPS_CHECK(at(list, backward) == (list_elem_t) (4 - i));
+
+            forward  = chainNext(list, forward,  0);
+            backward = chainNext(list, backward, 1);
+        }
+
+        LIST_OPS_CHECK(forward == 0 && backward == 0);
+
+        // indices change, the orders mustn't
+        LIST_SLOW::switchToIndexSearch(list);
+    }
+
+    int index = 0;
+    LIST_OPS_CHECK(find(list, 2, &index, NULL));
+    remove(list, index);
+
+    LIST_OPS_CHECK(at(list, chainNext(list, chainNext(list, 0, 1), 1)) == 3);
+    LIST_OPS_CHECK(at(list, chainNext(list, chainNext(list, 0, 0), 0)) == 3);
+
+    deleteList(list);
+}
+
+//-----------------------------------------------------------------------------
+//! Property test of the list and the containers built on it against 
+//! standard library models. Replays the files 
+//! given as arguments (the fuzzing corpus), then runs random operation 
+//! sequences. Set LIST_TEST_SEED to reproduce a run with another seed.
+//-----------------------------------------------------------------------------
+int main(int argc, const char* argv[])
+{
+    testNewList();
+    testNewListChains();
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!runFile(argv[i]))
+        {
+            printf("Couldn't read %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    const char* seedStr = getenv("LIST_TEST_SEED");
+    unsigned    seed    = seedStr != NULL ? (unsigned) strtoul(seedStr, NULL, 10) : LIST_TEST_DEFAULT_SEED;
+
+    srand(seed);
+
+    uint8_t data[LIST_TEST_MAX_LENGTH] = {};
+    for (size_t sequence = 0; sequence < LIST_TEST_SEQUENCES; sequence++)
+    {
+        size_t size = rand() % LIST_TEST_MAX_LENGTH;
+        for (size_t i = 0; i < size; i++)
+        {
+            data[i] = rand();
+        }
+
+        runOps(data, size);
+    }
+
+    printf("%d corpus files and %zu random sequences passed (seed %u)\n", argc - 1, LIST_TEST_SEQUENCES, seed);
+
+    LG_Close();
+
+    return 0;
+}
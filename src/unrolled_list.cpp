@@ -0,0 +1,637 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "unrolled_list.h"
+
+const size_t UNROLLED_MINIMAL_BLOCKS = 2;
+
+static_assert(UNROLLED_BLOCK_VALUES <= UNROLLED_OFFSET_MASK + 1, "offset doesn't fit in its bits");
+static_assert(sizeof(UnrolledBlock) == LIST_NODES_ALIGNMENT,      "block doesn't fill a cache line");
+
+bool           unrolledIsUsed    (UnrolledList* list, size_t idx);
+UnrolledBlock* unrolledAllocBlocks(size_t capacity, void** block);
+bool           unrolledGrow      (UnrolledList* list);
+void           unrolledLinkFree  (UnrolledList* list, size_t first);
+size_t         unrolledTakeBlock (UnrolledList* list, size_t after);
+void           unrolledFreeBlock (UnrolledList* list, size_t block);
+
+//-----------------------------------------------------------------------------
+//! UnrolledList's constructor.
+//!
+//! @param [out] list
+//! @param [in]  capacity   number of values to make room for
+//!
+//! @note if calloc returned NULL then sets list's errorStatus to
+//!       LIST_CONSTRUCTION_FAILED.
+//!
+//! @return list if constructed successfully or NULL otherwise.
+//-----------------------------------------------------------------------------
+UnrolledList* constructUnrolledList(UnrolledList* list, size_t capacity)
+{
+    assert(list != NULL);
+
+    size_t blocks = capacity / UNROLLED_BLOCK_VALUES + 1;
+
+    list->capacity = blocks > UNROLLED_MINIMAL_BLOCKS ? blocks : UNROLLED_MINIMAL_BLOCKS;
+    list->blocks   = unrolledAllocBlocks(list->capacity, &list->blocksBlock);
+
+    if (list->blocks == NULL)
+    {
+        list->errorStatus |= LIST_CONSTRUCTION_FAILED;
+        return NULL;
+    }
+
+    list->size = 0;
+    list->head = 0;
+    list->tail = 0;
+
+    unrolledLinkFree(list, 1);
+
+    ASSERT_UNROLLED_LIST_OK(list);
+
+    return list;
+}
+
+//-----------------------------------------------------------------------------
+//! UnrolledList's destructor.
+//!
+//! @param [out] list
+//-----------------------------------------------------------------------------
+void destructUnrolledList(UnrolledList* list)
+{
+    ASSERT_UNROLLED_LIST_OK(list);
+
+    free(list->blocksBlock);
+
+    list->blocks      = NULL;
+    list->blocksBlock = NULL;
+    list->size        = 0;
+    list->capacity    = 0;
+    list->head        = 0;
+    list->tail        = 0;
+    list->free        = 0;
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] list
+//!
+//! @return current size of list.
+//-----------------------------------------------------------------------------
+size_t getSize(UnrolledList* list)
+{
+    ASSERT_UNROLLED_LIST_OK(list);
+
+    return list->size;
+}
+
+//-----------------------------------------------------------------------------
+//! Inserts value to list after element with index idx. If idx's block is
+//! full, its upper half is moved to a new block first, unless value goes
+//! to the end of list's tail block or to the front of list, in which case
+//! it starts a new block.
+//!
+//! @param [out] list
+//! @param [in]  value
+//! @param [in]  idx   0 inserts value at the front
+//!
+//! @note if reallocation failed then sets list's errorStatus to
+//!       LIST_REALLOCATION_FAILED and returns 0.
+//!
+//! @return index at which value was inserted.
+//-----------------------------------------------------------------------------
+int insertAfter(UnrolledList* list, list_elem_t value, size_t idx)
+{
+    ASSERT_UNROLLED_LIST_OK(list);
+    assert(idx == 0 || unrolledIsUsed(list, idx));
+
+    size_t block  = idx >> UNROLLED_OFFSET_BITS;
+    size_t offset = (idx & UNROLLED_OFFSET_MASK) + 1;
+
+    if (idx == 0)
+    {
+        block  = list->head != 0 ? list->head : unrolledTakeBlock(list, 0);
+        offset = 0;
+
+        if (block == 0) { return 0; }
+    }
+
+    bool full = list->blocks[block].count == UNROLLED_BLOCK_VALUES;
+
+    // appending to a full tail or prepending to a full head starts a new
+    // block, so sequential inserts leave full blocks instead of half-full ones
+    if (full && block == list->tail && offset == UNROLLED_BLOCK_VALUES)
+    {
+        block  = unrolledTakeBlock(list, block);
+        offset = 0;
+
+        if (block == 0) { return 0; }
+    }
+    else if (full && block == list->head && offset == 0)
+    {
+        block = unrolledTakeBlock(list, 0);
+
+        if (block == 0) { return 0; }
+    }
+    else if (full)
+    {
+        size_t newBlock = unrolledTakeBlock(list, block);
+        if (newBlock == 0) { return 0; }
+
+        size_t kept  = UNROLLED_BLOCK_VALUES / 2;
+        size_t moved = UNROLLED_BLOCK_VALUES - kept;
+
+        memcpy(list->blocks[newBlock].values, list->blocks[block].values + kept, moved * sizeof(list_elem_t));
+
+        list->blocks[block].count    = kept;
+        list->blocks[newBlock].count = moved;
+
+        if (offset > kept)
+        {
+            block   = newBlock;
+            offset -= kept;
+        }
+    }
+
+    UnrolledBlock* current = &list->blocks[block];
+
+    memmove(current->values + offset + 1, current->values + offset, (current->count - offset) * sizeof(list_elem_t));
+
+    current->values[offset] = value;
+    current->count++;
+    list->size++;
+
+    ASSERT_UNROLLED_LIST_OK(list);
+
+    return (block << UNROLLED_OFFSET_BITS) | offset;
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] list
+//! @param [in] idx
+//!
+//! @return element at idx.
+//-----------------------------------------------------------------------------
+list_elem_t at(UnrolledList* list, size_t idx)
+{
+    ASSERT_UNROLLED_LIST_OK(list);
+    assert(unrolledIsUsed(list, idx));
+
+    return list->blocks[idx >> UNROLLED_OFFSET_BITS].values[idx & UNROLLED_OFFSET_MASK];
+}
+
+//-----------------------------------------------------------------------------
+//! Removes element at idx from list. An emptied block is freed and a block
+//! left less than half full takes the values of the next one if they fit.
+//!
+//! @param [out] list
+//! @param [in]  idx
+//!
+//! @return element removed.
+//-----------------------------------------------------------------------------
+list_elem_t remove(UnrolledList* list, size_t idx)
+{
+    ASSERT_UNROLLED_LIST_OK(list);
+    assert(unrolledIsUsed(list, idx));
+
+    size_t         block   = idx >> UNROLLED_OFFSET_BITS;
+    size_t         offset  = idx &  UNROLLED_OFFSET_MASK;
+    UnrolledBlock* current = &list->blocks[block];
+    list_elem_t    value   = current->values[offset];
+
+    current->count--;
+    memmove(current->values + offset, current->values + offset + 1, (current->count - offset) * sizeof(list_elem_t));
+
+    list->size--;
+
+    if (current->count == 0)
+    {
+        unrolledFreeBlock(list, block);
+    }
+    else if (current->count < UNROLLED_BLOCK_VALUES / 2 && current->next != 0)
+    {
+        UnrolledBlock* next = &list->blocks[current->next];
+
+        if (current->count + next->count <= UNROLLED_BLOCK_VALUES)
+        {
+            memcpy(current->values + current->count, next->values, next->count * sizeof(list_elem_t));
+            current->count += next->count;
+
+            unrolledFreeBlock(list, current->next);
+        }
+    }
+
+    ASSERT_UNROLLED_LIST_OK(list);
+
+    return value;
+}
+
+//-----------------------------------------------------------------------------
+//! Empties the list.
+//!
+//! @param [out] list
+//-----------------------------------------------------------------------------
+void clear(UnrolledList* list)
+{
+    ASSERT_UNROLLED_LIST_OK(list);
+
+    list->size = 0;
+    list->head = 0;
+    list->tail = 0;
+
+    unrolledLinkFree(list, 1);
+
+    ASSERT_UNROLLED_LIST_OK(list);
+}
+
+//-----------------------------------------------------------------------------
+//! Inserts value at the end of list.
+//!
+//! @param [out] list
+//! @param [in]  value
+//!
+//! @return index at which value was inserted.
+//-----------------------------------------------------------------------------
+int pushBack(UnrolledList* list, list_elem_t value)
+{
+    ASSERT_UNROLLED_LIST_OK(list);
+
+    if (list->tail == 0) { return insertAfter(list, value, 0); }
+
+    return insertAfter(list, value, (list->tail << UNROLLED_OFFSET_BITS) | (list->blocks[list->tail].count - 1));
+}
+
+//-----------------------------------------------------------------------------
+//! Inserts value at the beginning of list.
+//!
+//! @param [out] list
+//! @param [in]  value
+//!
+//! @return index at which value was inserted.
+//-----------------------------------------------------------------------------
+int pushFront(UnrolledList* list, list_elem_t value)
+{
+    ASSERT_UNROLLED_LIST_OK(list);
+
+    return insertAfter(list, value, 0);
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] list
+//! @param [in] idx   index of an element or 0
+//!
+//! @return index of the element following idx (list's first element if idx
+//!         is 0) or 0 if there's none.
+//-----------------------------------------------------------------------------
+int nextIndex(UnrolledList* list, size_t idx)
+{
+    ASSERT_UNROLLED_LIST_OK(list);
+    assert(idx == 0 || unrolledIsUsed(list, idx));
+
+    size_t block = idx >> UNROLLED_OFFSET_BITS;
+
+    if (idx != 0 && (idx & UNROLLED_OFFSET_MASK) + 1 < list->blocks[block].count) { return idx + 1; }
+
+    size_t next = idx != 0 ? list->blocks[block].next : list->head;
+
+    return next << UNROLLED_OFFSET_BITS;
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] list
+//! @param [in] block   a block of list or 0
+//!
+//! @return block following block (list's first block if block is 0) or 0 if
+//!         there's none.
+//-----------------------------------------------------------------------------
+size_t nextBlock(UnrolledList* list, size_t block)
+{
+    ASSERT_UNROLLED_LIST_OK(list);
+    assert(block < list->capacity);
+
+    return block != 0 ? list->blocks[block].next : list->head;
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in]  list
+//! @param [in]  block   a block of list
+//! @param [out] count   set to the number of values in block
+//!
+//! @return values of block in list's order.
+//-----------------------------------------------------------------------------
+list_elem_t* blockValues(UnrolledList* list, size_t block, size_t* count)
+{
+    ASSERT_UNROLLED_LIST_OK(list);
+    assert(block > 0 && block < list->capacity);
+    assert(count != NULL);
+
+    *count = list->blocks[block].count;
+
+    return list->blocks[block].values;
+}
+
+//-----------------------------------------------------------------------------
+//! Finds first occurrence of value in list.
+//!
+//! @param [in]  list
+//! @param [in]  value
+//! @param [out] idx
+//! @param [out] pos   can be NULL
+//!
+//! @return whether or not element with this value has been found.
+//-----------------------------------------------------------------------------
+bool find(UnrolledList* list, list_elem_t value, int* idx, int* pos)
+{
+    ASSERT_UNROLLED_LIST_OK(list);
+    assert(idx != NULL);
+
+    size_t blockPos = 1;
+    for (size_t block = list->head; block != 0; block = list->blocks[block].next)
+    {
+        UnrolledBlock* current = &list->blocks[block];
+
+        LIST_PREFETCH(&list->blocks[current->next]);
+
+        for (size_t offset = 0; offset < current->count; offset++)
+        {
+            if (current->values[offset] == value)
+            {
+                *idx = (block << UNROLLED_OFFSET_BITS) | offset;
+                if (pos != NULL) { *pos = blockPos + offset; }
+
+                return true;
+            }
+        }
+
+        blockPos += current->count;
+    }
+
+    *idx = 0;
+    if (pos != NULL) { *pos = 0; }
+
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] list
+//!
+//! @return whether or not list's blocks are linked correctly, every used
+//!         block holds from 1 to UNROLLED_BLOCK_VALUES values and their
+//!         number adds up to list's size.
+//-----------------------------------------------------------------------------
+bool unrolledListOk(UnrolledList* list)
+{
+    if (list == NULL || list->blocks == NULL) { return false; }
+    if (list->errorStatus != 0)               { return false; }
+
+    size_t size   = 0;
+    size_t blocks = 0;
+    size_t prev   = 0;
+
+    for (size_t block = list->head; block != 0; block = list->blocks[block].next)
+    {
+        if (block >= list->capacity || ++blocks >= list->capacity) { return false; }
+
+        UnrolledBlock* current = &list->blocks[block];
+
+        if (current->prev != (int) prev)                                  { return false; }
+        if (current->count == 0 || current->count > UNROLLED_BLOCK_VALUES) { return false; }
+
+        size += current->count;
+        prev  = block;
+    }
+
+    if (prev != list->tail || size != list->size) { return false; }
+
+    for (size_t block = list->free; block != 0; block = list->blocks[block].next)
+    {
+        if (block >= list->capacity || ++blocks >= list->capacity) { return false; }
+        if (list->blocks[block].prev != -1)                        { return false; }
+    }
+
+    return blocks == list->capacity - 1;
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] list
+//! @param [in] idx
+//!
+//! @return whether or not there's an element at idx.
+//-----------------------------------------------------------------------------
+bool unrolledIsUsed(UnrolledList* list, size_t idx)
+{
+    assert(list != NULL);
+
+    size_t block = idx >> UNROLLED_OFFSET_BITS;
+
+    return block > 0 && block < list->capacity && list->blocks[block].prev != -1 &&
+           (idx & UNROLLED_OFFSET_MASK) < list->blocks[block].count;
+}
+
+//-----------------------------------------------------------------------------
+//! Allocates zeroed memory for capacity blocks aligned to cache lines.
+//!
+//! @param [in]  capacity
+//! @param [out] block   set to the allocated memory block, which is the one
+//!              to be freed
+//!
+//! @return pointer to the first block or NULL if calloc returned NULL.
+//-----------------------------------------------------------------------------
+UnrolledBlock* unrolledAllocBlocks(size_t capacity, void** block)
+{
+    assert(block != NULL);
+
+    *block = calloc(1, capacity * sizeof(UnrolledBlock) + LIST_NODES_ALIGNMENT - 1);
+    if (*block == NULL) { return NULL; }
+
+    uintptr_t address = ((uintptr_t) *block + LIST_NODES_ALIGNMENT - 1) / LIST_NODES_ALIGNMENT * LIST_NODES_ALIGNMENT;
+
+    return (UnrolledBlock*) address;
+}
+
+//-----------------------------------------------------------------------------
+//! Grows list's blocks array by LIST_EXPAND_MULTIPLIER.
+//!
+//! @param [out] list
+//!
+//! @note if calloc returned NULL then sets list's errorStatus to
+//!       LIST_REALLOCATION_FAILED.
+//!
+//! @return whether or not list has grown.
+//-----------------------------------------------------------------------------
+bool unrolledGrow(UnrolledList* list)
+{
+    assert(list != NULL);
+
+    size_t newCapacity = list->capacity * LIST_EXPAND_MULTIPLIER;
+    if (newCapacity <= list->capacity) { newCapacity = list->capacity + 1; }
+
+    void*          newBlock  = NULL;
+    UnrolledBlock* newBlocks = unrolledAllocBlocks(newCapacity, &newBlock);
+
+    if (newBlocks == NULL)
+    {
+        list->errorStatus |= LIST_REALLOCATION_FAILED;
+        return false;
+    }
+
+    memcpy(newBlocks, list->blocks, list->capacity * sizeof(UnrolledBlock));
+    free(list->blocksBlock);
+
+    size_t oldCapacity = list->capacity;
+
+    list->blocks      = newBlocks;
+    list->blocksBlock = newBlock;
+    list->capacity    = newCapacity;
+
+    unrolledLinkFree(list, oldCapacity);
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//! Makes blocks from first to the end of list's array free.
+//!
+//! @param [out] list
+//! @param [in]  first   blocks from first must not be used by list
+//-----------------------------------------------------------------------------
+void unrolledLinkFree(UnrolledList* list, size_t first)
+{
+    assert(list != NULL);
+    assert(first > 0);
+
+    for (size_t block = first; block < list->capacity; block++)
+    {
+        list->blocks[block].prev  = -1;
+        list->blocks[block].next  = block + 1 < list->capacity ? block + 1 : 0;
+        list->blocks[block].count = 0;
+    }
+
+    list->free = first < list->capacity ? first : 0;
+}
+
+//-----------------------------------------------------------------------------
+//! Takes an empty block and links it after block after.
+//!
+//! @param [out] list
+//! @param [in]  after   0 links the block at the front
+//!
+//! @return taken block or 0 if list couldn't grow.
+//-----------------------------------------------------------------------------
+size_t unrolledTakeBlock(UnrolledList* list, size_t after)
+{
+    assert(list != NULL);
+
+    if (list->free == 0 && !unrolledGrow(list)) { return 0; }
+
+    size_t taken = list->free;
+    list->free   = list->blocks[taken].next;
+
+    size_t next = after != 0 ? list->blocks[after].next : list->head;
+
+    list->blocks[taken].prev  = after;
+    list->blocks[taken].next  = next;
+    list->blocks[taken].count = 0;
+
+    if (after != 0) { list->blocks[after].next = taken; }
+    else            { list->head               = taken; }
+
+    if (next  != 0) { list->blocks[next].prev  = taken; }
+    else            { list->tail               = taken; }
+
+    return taken;
+}
+
+//-----------------------------------------------------------------------------
+//! Unlinks block from list and makes it free.
+//!
+//! @param [out] list
+//! @param [in]  block
+//-----------------------------------------------------------------------------
+void unrolledFreeBlock(UnrolledList* list, size_t block)
+{
+    assert(list != NULL);
+
+    size_t prev = list->blocks[block].prev;
+    size_t next = list->blocks[block].next;
+
+    if (prev != 0) { list->blocks[prev].next = next; }
+    else           { list->head              = next; }
+
+    if (next != 0) { list->blocks[next].prev = prev; }
+    else           { list->tail              = prev; }
+
+    list->blocks[block].prev  = -1;
+    list->blocks[block].next  = list->free;
+    list->blocks[block].count = 0;
+
+    list->free = block;
+}
+
+namespace LIST_SLOW
+{
+
+//-----------------------------------------------------------------------------
+//! Finds index of the element with position pos in list. Walks block by
+//! block from the end of list closest to pos.
+//!
+//! @param [in] list
+//! @param [in] pos   from 1 to list's size
+//!
+//! @return found index.
+//-----------------------------------------------------------------------------
+int findIndex(UnrolledList* list, size_t pos)
+{
+    ASSERT_UNROLLED_LIST_OK(list);
+    assert(pos >= 1 && pos <= list->size);
+
+    if (pos > list->size / 2)
+    {
+        size_t after = list->size - pos;
+        size_t block = list->tail;
+
+        while (after >= list->blocks[block].count)
+        {
+            after -= list->blocks[block].count;
+            block  = list->blocks[block].prev;
+        }
+
+        return (block << UNROLLED_OFFSET_BITS) | (list->blocks[block].count - 1 - after);
+    }
+
+    size_t before = pos - 1;
+    size_t block  = list->head;
+
+    while (before >= list->blocks[block].count)
+    {
+        before -= list->blocks[block].count;
+        block   = list->blocks[block].next;
+    }
+
+    return (block << UNROLLED_OFFSET_BITS) | before;
+}
+
+//-----------------------------------------------------------------------------
+//! Finds position of the element at idx in list.
+//!
+//! @param [in] list
+//! @param [in] idx
+//!
+//! @return found position or 0 if there's no element at idx.
+//-----------------------------------------------------------------------------
+int findPos(UnrolledList* list, size_t idx)
+{
+    ASSERT_UNROLLED_LIST_OK(list);
+
+    if (!unrolledIsUsed(list, idx)) { return 0; }
+
+    size_t pos = (idx & UNROLLED_OFFSET_MASK) + 1;
+
+    for (size_t block = list->blocks[idx >> UNROLLED_OFFSET_BITS].prev; block != 0; block = list->blocks[block].prev)
+    {
+        pos += list->blocks[block].count;
+    }
+
+    return pos;
+}
+
+}
@@ -0,0 +1,78 @@
+#ifndef UNROLLED_LIST_H
+#define UNROLLED_LIST_H
+
+#include <stdint.h>
+#include "list.h"
+
+#ifdef LIST_DEBUG_MODE
+#define ASSERT_UNROLLED_LIST_OK(list) assert(list != NULL && unrolledListOk(list))
+#else
+#define ASSERT_UNROLLED_LIST_OK(list)
+#endif
+
+static const size_t UNROLLED_BLOCK_VALUES = 6;
+static const size_t UNROLLED_OFFSET_BITS  = 3;
+static const size_t UNROLLED_OFFSET_MASK  = (1 << UNROLLED_OFFSET_BITS) - 1;
+
+//-----------------------------------------------------------------------------
+//! Link of an unrolled list holding up to UNROLLED_BLOCK_VALUES values, so
+//! that a whole block fits in one cache line. Free blocks have prev = -1.
+//-----------------------------------------------------------------------------
+struct alignas(LIST_NODES_ALIGNMENT) UnrolledBlock
+{
+    list_elem_t values[UNROLLED_BLOCK_VALUES];
+    int         prev;
+    int         next;
+    uint32_t    count;
+};
+
+//-----------------------------------------------------------------------------
+//! List of blocks of values. An element's index encodes its block and its
+//! offset in the block: (block << UNROLLED_OFFSET_BITS) | offset, so 0 is
+//! never an element's index. Blocks are split when full and merged with the
+//! next one when less than half full.
+//!
+//! @warning Splitting and merging move values between blocks, so indices
+//!          stay valid only until the next insert or remove.
+//-----------------------------------------------------------------------------
+struct UnrolledList
+{
+    UnrolledBlock* blocks      = NULL;
+    void*          blocksBlock = NULL;
+    size_t         size        = 0;
+    size_t         capacity    = 0;
+
+    size_t         head        = 0;
+    size_t         tail        = 0;
+    size_t         free        = 0;
+    uint32_t       errorStatus = 0;
+};
+
+UnrolledList* constructUnrolledList(UnrolledList* list, size_t capacity);
+void          destructUnrolledList (UnrolledList* list);
+
+size_t        getSize      (UnrolledList* list);
+int           insertAfter  (UnrolledList* list, list_elem_t value, size_t idx);
+list_elem_t   at           (UnrolledList* list, size_t idx);
+list_elem_t   remove       (UnrolledList* list, size_t idx);
+void          clear        (UnrolledList* list);
+
+int           pushBack     (UnrolledList* list, list_elem_t value);
+int           pushFront    (UnrolledList* list, list_elem_t value);
+
+int           nextIndex    (UnrolledList* list, size_t idx);
+size_t        nextBlock    (UnrolledList* list, size_t block);
+list_elem_t*  blockValues  (UnrolledList* list, size_t block, size_t* count);
+
+bool          find         (UnrolledList* list, list_elem_t value, int* idx, int* pos);
+bool          unrolledListOk(UnrolledList* list);
+
+namespace LIST_SLOW
+{
+
+int    findIndex           (UnrolledList* list, size_t pos);
+int    findPos             (UnrolledList* list, size_t idx);
+
+}
+
+#endif
@@ -0,0 +1,267 @@
+#ifndef UNROLLED_LIST_OPS_H
+#define UNROLLED_LIST_OPS_H
+
+#include <stdint.h>
+#include <vector>
+#include "list_ops.h"
+#include "unrolled_list.h"
+
+//-----------------------------------------------------------------------------
+//! Interpreter of byte strings as sequences of unrolled list operations,
+//! the UnrolledList counterpart of list_ops.h. Every operation is applied
+//! both to an UnrolledList and to a std::vector model.
+//-----------------------------------------------------------------------------
+
+enum UnrolledListOp
+{
+    UNROLLED_OP_PUSH_BACK,
+    UNROLLED_OP_PUSH_FRONT,
+    UNROLLED_OP_REMOVE,
+    UNROLLED_OP_APPEND_RUN,
+    UNROLLED_OP_PREPEND_RUN,
+    UNROLLED_OP_INSERT_AFTER,
+    UNROLLED_OP_FIND,
+    UNROLLED_OP_CLEAR,
+
+    UNROLLED_OPS_COUNT
+};
+
+typedef std::vector<list_elem_t> UnrolledListModel;
+
+//-----------------------------------------------------------------------------
+//! @param [in] list
+//!
+//! @return number of blocks holding list's values.
+//-----------------------------------------------------------------------------
+inline size_t unrolledOpsBlocks(UnrolledList* list)
+{
+    size_t blocks = 0;
+    for (size_t block = nextBlock(list, 0); block != 0; block = nextBlock(list, block))
+    {
+        blocks++;
+    }
+
+    return blocks;
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in] values   number of values inserted at one end of a list
+//! @param [in] room     number of values that fitted in the block at that end
+//!
+//! @return number of blocks the inserts must have added.
+//-----------------------------------------------------------------------------
+inline size_t unrolledOpsAddedBlocks(size_t values, size_t room)
+{
+    if (values <= room) { return 0; }
+
+    return (values - room + UNROLLED_BLOCK_VALUES - 1) / UNROLLED_BLOCK_VALUES;
+}
+
+//-----------------------------------------------------------------------------
+//! Checks that list holds the same elements as model in the same order.
+//!
+//! @param [in] list
+//! @param [in] model
+//! @param [in] checkedPos   the only position to check or 0 to walk the
+//!                          whole list and check every position (O(n^2)
+//!                          in debug mode, where every call checks list)
+//-----------------------------------------------------------------------------
+inline void unrolledOpsCheck(UnrolledList* list, UnrolledListModel* model, size_t checkedPos)
+{
+    LIST_OPS_CHECK(unrolledListOk(list));
+    LIST_OPS_CHECK(getSize(list) == model->size());
+
+    if (checkedPos != 0)
+    {
+        if (checkedPos > model->size()) { return; }
+
+        int index = LIST_SLOW::findIndex(list, checkedPos);
+
+        LIST_OPS_CHECK(at(list, index) == (*model)[checkedPos - 1]);
+        LIST_OPS_CHECK((size_t) LIST_SLOW::findPos(list, index) == checkedPos);
+
+        return;
+    }
+
+    size_t index = nextIndex(list, 0);
+    size_t pos   = 1;
+
+    for (list_elem_t value : *model)
+    {
+        LIST_OPS_CHECK(index != 0);
+        LIST_OPS_CHECK(at(list, index) == value);
+        LIST_OPS_CHECK((size_t) LIST_SLOW::findIndex(list, pos) == index);
+        LIST_OPS_CHECK((size_t) LIST_SLOW::findPos  (list, index) == pos);
+
+        index = nextIndex(list, index);
+        pos++;
+    }
+
+    LIST_OPS_CHECK(index == 0);
+}
+
+//-----------------------------------------------------------------------------
+//! Applies the operation read from input to list and model.
+//!
+//! @param [out] list
+//! @param [out] model
+//! @param [out] input
+//-----------------------------------------------------------------------------
+inline void unrolledOpsStep(UnrolledList* list, UnrolledListModel* model, ListOpsInput* input)
+{
+    uint8_t op   = listOpsByte(input) % UNROLLED_OPS_COUNT;
+    size_t  size = model->size();
+
+    switch (op)
+    {
+        case UNROLLED_OP_PUSH_BACK:
+        {
+            if (size >= LIST_OPS_MAX_SIZE) { break; }
+
+            list_elem_t value = listOpsByte(input) % LIST_OPS_VALUES;
+
+            LIST_OPS_CHECK(pushBack(list, value) != 0);
+            model->push_back(value);
+            break;
+        }
+
+        case UNROLLED_OP_PUSH_FRONT:
+        {
+            if (size >= LIST_OPS_MAX_SIZE) { break; }
+
+            list_elem_t value = listOpsByte(input) % LIST_OPS_VALUES;
+
+            LIST_OPS_CHECK(pushFront(list, value) != 0);
+            model->insert(model->begin(), value);
+            break;
+        }
+
+        case UNROLLED_OP_REMOVE:
+        {
+            if (size == 0) { break; }
+
+            size_t pos = listOpsByte(input) % size + 1;
+
+            LIST_OPS_CHECK(remove(list, LIST_SLOW::findIndex(list, pos)) == (*model)[pos - 1]);
+            model->erase(model->begin() + (pos - 1));
+            break;
+        }
+
+        // sequential inserts at either end must fill blocks up instead of
+        // splitting them
+        case UNROLLED_OP_APPEND_RUN:
+        case UNROLLED_OP_PREPEND_RUN:
+        {
+            bool   append = op == UNROLLED_OP_APPEND_RUN;
+            size_t count  = std::min((size_t) listOpsByte(input) % 32, LIST_OPS_MAX_SIZE - size);
+            size_t end    = append ? list->tail : list->head;
+            size_t room   = end != 0 ? UNROLLED_BLOCK_VALUES - list->blocks[end].count : 0;
+            size_t blocks = unrolledOpsBlocks(list);
+
+            for (size_t i = 0; i < count; i++)
+            {
+                list_elem_t value = (list_elem_t) (i % LIST_OPS_VALUES);
+
+                if (append)
+                {
+                    LIST_OPS_CHECK(pushBack(list, value) != 0);
+                    model->push_back(value);
+                }
+                else
+                {
+                    LIST_OPS_CHECK(pushFront(list, value) != 0);
+                    model->insert(model->begin(), value);
+                }
+            }
+
+            LIST_OPS_CHECK(unrolledOpsBlocks(list) == blocks + unrolledOpsAddedBlocks(count, room));
+            break;
+        }
+
+        case UNROLLED_OP_INSERT_AFTER:
+        {
+            if (size >= LIST_OPS_MAX_SIZE) { break; }
+
+            size_t      pos   = listOpsByte(input) % (size + 1);
+            list_elem_t value = listOpsByte(input) % LIST_OPS_VALUES;
+
+            int index = insertAfter(list, value, pos > 0 ? LIST_SLOW::findIndex(list, pos) : 0);
+            model->insert(model->begin() + pos, value);
+
+            LIST_OPS_CHECK(index != 0 && at(list, index) == value);
+            break;
+        }
+
+        case UNROLLED_OP_FIND:
+        {
+            list_elem_t value = listOpsByte(input) % LIST_OPS_VALUES;
+
+            int  index = 0;
+            int  pos   = 0;
+            bool found = find(list, value, &index, &pos);
+
+            UnrolledListModel::iterator first = std::find(model->begin(), model->end(), value);
+
+            LIST_OPS_CHECK(found == (first != model->end()));
+
+            if (found)
+            {
+                LIST_OPS_CHECK((size_t) pos == (size_t) (first - model->begin()) + 1);
+                LIST_OPS_CHECK(at(list, index) == value);
+            }
+            else
+            {
+                LIST_OPS_CHECK(index == 0 && pos == 0);
+            }
+
+            break;
+        }
+
+        case UNROLLED_OP_CLEAR:
+        {
+            // clearing too often would keep the list short
+            if (listOpsByte(input) % 8 != 0) { break; }
+
+            clear(list);
+            model->clear();
+            break;
+        }
+
+        default:
+        {
+            break;
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//! Runs the operations encoded by data on a new unrolled list, checking it
+//! against the model after every one of them and fully at the end. Aborts
+//! on the first mismatch.
+//!
+//! @param [in] data
+//! @param [in] size
+//-----------------------------------------------------------------------------
+inline void runUnrolledListOps(const uint8_t* data, size_t size)
+{
+    ListOpsInput input = {};
+    input.data = data;
+    input.size = size;
+
+    UnrolledList list = {};
+    LIST_OPS_CHECK(constructUnrolledList(&list, listOpsByte(&input) % 16) != NULL);
+
+    UnrolledListModel model = {};
+
+    while (input.read < input.size)
+    {
+        unrolledOpsStep(&list, &model, &input);
+        unrolledOpsCheck(&list, &model, input.read % (model.size() + 1));
+    }
+
+    unrolledOpsCheck(&list, &model, 0);
+
+    destructUnrolledList(&list);
+}
+
+#endif